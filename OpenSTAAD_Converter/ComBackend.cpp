@@ -0,0 +1,127 @@
+#include "ComBackend.h"
+#include "STAADUtilities.h"
+#include <comdef.h>
+#include <filesystem>
+#include <iostream>
+
+using namespace std;
+using namespace OpenSTAADUI;
+
+ComBackend::~ComBackend() {
+    geometry_ = nullptr;
+    staadApp_ = nullptr;
+    if (comInitialized_) CoUninitialize();
+}
+
+bool ComBackend::Open() {
+    if (staadApp_) return true;
+    if (!comInitialized_) {
+        HRESULT hr = CoInitializeEx(NULL, COINIT_APARTMENTTHREADED);
+        if (FAILED(hr)) {
+            cerr << "Failed to initialize COM" << endl;
+            return false;
+        }
+        comInitialized_ = true;
+    }
+    staadApp_ = STAADWrapper::Attach();
+    if (staadApp_ == nullptr) {
+        cerr << "Failed to initialize STAAD" << endl;
+        return false;
+    }
+    return true;
+}
+
+bool ComBackend::NewModel(const string& stdPath, const UnitSystem& units, UpAxis up) {
+    if (!SupportsUpAxis(up)) {
+        cerr << "ERROR: The staad backend only builds Y-up models" << endl;
+        return false;
+    }
+    if (!Open()) return false;
+    if (!STAADWrapper::NewFile(staadApp_, filesystem::u8path(stdPath).wstring(),
+        units.lengthUnit, units.forceUnit)) {
+        return false;
+    }
+
+    try {
+        geometry_ = staadApp_->GetGeometry();
+        STAADUtilities::WaitForGeometryReady(geometry_);
+    }
+    catch (_com_error& e) {
+        cerr << "STAAD Error: " << e.ErrorMessage() << endl;
+        return false;
+    }
+    catch (const std::exception& e) {
+        cerr << "Error: " << e.what() << endl;
+        return false;
+    }
+    return true;
+}
+
+bool ComBackend::CreateNodes(ModelVector<Node>& nodes) {
+    return STAADWrapper::CreateNodes(geometry_, nodes);
+}
+
+bool ComBackend::CreateBeams(ModelVector<Beam>& beams) {
+    return STAADWrapper::CreateBeams(geometry_, beams, STAADWrapper::GetNodeMap());
+}
+
+bool ComBackend::CreateCables(ModelVector<Cable>& cables) {
+    return STAADWrapper::CreateCables(geometry_, cables, STAADWrapper::GetNodeMap());
+}
+
+bool ComBackend::CreateSupports(const ModelVector<JointRestraint>& restraints,
+    const ModelVector<JointSpring>& springs) {
+    try {
+        IOSSupportUIPtr supports = staadApp_->GetSupport();
+        return STAADWrapper::CreateSupports(supports, restraints, springs, STAADWrapper::GetNodeMap());
+    }
+    catch (_com_error& e) {
+        cerr << "COM Error in GetSupport: " << e.ErrorMessage() << endl;
+        return false;
+    }
+}
+
+bool ComBackend::AssignBetaAngles(const ModelVector<Beam>& beams) {
+    try {
+        return STAADWrapper::AssignBetaAngles(staadApp_->GetProperty(), beams);
+    }
+    catch (_com_error& e) {
+        cerr << "COM Error in GetProperty: " << e.ErrorMessage() << endl;
+        return false;
+    }
+}
+
+bool ComBackend::AssignMemberOffsets(const ModelVector<FrameInsertion>& insertions,
+    const ModelVector<Beam>& beams) {
+    try {
+        return STAADWrapper::AssignMemberOffsets(staadApp_->GetProperty(), insertions, beams);
+    }
+    catch (_com_error& e) {
+        cerr << "COM Error in GetProperty: " << e.ErrorMessage() << endl;
+        return false;
+    }
+}
+
+bool ComBackend::CreateLoadCombinations(const vector<string>& patternNames,
+    const vector<string>& comboNames,
+    const CombinationMatrix& combinations) {
+    try {
+        return STAADWrapper::CreateLoadCombinations(staadApp_->GetLoad(), patternNames, comboNames, combinations);
+    }
+    catch (_com_error& e) {
+        cerr << "COM Error in GetLoad: " << e.ErrorMessage() << endl;
+        return false;
+    }
+}
+
+bool ComBackend::Save() {
+    try {
+        _variant_t varSilent(1L);
+        staadApp_->SaveModel(varSilent);
+        return true;
+    }
+    catch (_com_error& e) {
+        cerr << "COM Error in SaveModel: " << e.ErrorMessage() << endl;
+        return false;
+    }
+}
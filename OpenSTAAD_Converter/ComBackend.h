@@ -0,0 +1,32 @@
+#pragma once
+#include "StaadBackend.h"
+#include "STAADWrapper.h"
+
+// Builds the model in the running STAAD.Pro through OpenSTAAD. Open
+// initializes COM and attaches once; every NewModel reuses that session.
+// All calls must come from the thread that called Open.
+class ComBackend : public StaadBackend {
+public:
+    ~ComBackend() override;
+    const char* Name() const override { return "staad"; }
+    bool Open() override;
+    // OpenSTAAD cannot change the Global Axes setting; new models are Y up
+    bool SupportsUpAxis(UpAxis up) const override { return up == UpAxis::Y; }
+    bool NewModel(const std::string& stdPath, const UnitSystem& units, UpAxis up) override;
+    bool CreateNodes(ModelVector<Node>& nodes) override;
+    bool CreateBeams(ModelVector<Beam>& beams) override;
+    bool CreateCables(ModelVector<Cable>& cables) override;
+    bool CreateSupports(const ModelVector<JointRestraint>& restraints,
+        const ModelVector<JointSpring>& springs) override;
+    bool AssignBetaAngles(const ModelVector<Beam>& beams) override;
+    bool AssignMemberOffsets(const ModelVector<FrameInsertion>& insertions,
+        const ModelVector<Beam>& beams) override;
+    bool CreateLoadCombinations(const std::vector<std::string>& patternNames,
+        const std::vector<std::string>& comboNames,
+        const CombinationMatrix& combinations) override;
+    bool Save() override;
+private:
+    OpenSTAADUI::IOpenSTAADUIPtr staadApp_;
+    OpenSTAADUI::IOSGeometryUIPtr geometry_;
+    bool comInitialized_ = false;
+};
@@ -0,0 +1,239 @@
+#include "ConversionFilter.h"
+#include <algorithm>
+#include <chrono>
+#include <fstream>
+#include <iostream>
+
+using namespace std;
+
+namespace {
+    const uint32_t kNone = UINT32_MAX;
+
+    template <typename T>
+    void Compact(ModelVector<T>& items, const vector<uint8_t>& keep, size_t offset = 0) {
+        size_t out = 0;
+        for (size_t i = 0; i < items.size(); ++i) {
+            if (keep[offset + i]) items[out++] = items[i];
+        }
+        items.resize(out);
+    }
+}
+
+ModelIndex::ModelIndex(const SAP2000Model& model)
+    : model_(model) {
+    const auto& c = model.coordinates;
+    const size_t jointCount = model.nodes.size();
+    const size_t beamCount = model.beams.size();
+    const size_t memberCount = beamCount + model.cables.size();
+
+    jointByLabel_ = model.NodeByLabel();
+    vector<BoundingBox> jointBoxes(jointCount);
+    for (uint32_t j = 0; j < jointCount; ++j) {
+        BoundingBox& box = jointBoxes[j];
+        box.min[0] = box.max[0] = c.x[j];
+        box.min[1] = box.max[1] = c.y[j];
+        box.min[2] = box.max[2] = c.z[j];
+    }
+    joints_.Build(move(jointBoxes));
+
+    // First frame and first cable with each label
+    memberByLabel_[0].assign(model.frameLabels.size(), kNone);
+    memberByLabel_[1].assign(model.cableLabels.size(), kNone);
+    for (uint32_t k = static_cast<uint32_t>(beamCount); k-- > 0;) {
+        memberByLabel_[0][model.beams[k].sapId] = k;
+    }
+    for (uint32_t k = static_cast<uint32_t>(model.cables.size()); k-- > 0;) {
+        memberByLabel_[1][model.cables[k].sapId] = k;
+    }
+
+    memberEnds_.resize(2 * memberCount);
+    incidenceOffsets_.assign(jointCount + 1, 0);
+    vector<BoundingBox> memberBoxes(memberCount);
+    for (size_t k = 0; k < memberCount; ++k) {
+        uint32_t start = k < beamCount ? model.beams[k].startNodeId : model.cables[k - beamCount].startNodeId;
+        uint32_t end = k < beamCount ? model.beams[k].endNodeId : model.cables[k - beamCount].endNodeId;
+        uint32_t a = jointByLabel_[start], b = jointByLabel_[end];
+        memberEnds_[2 * k] = a;
+        memberEnds_[2 * k + 1] = b;
+        if (a == kNone || b == kNone) {
+            // Dangling member: empty box far away, never selected
+            for (int axis = 0; axis < 3; ++axis) {
+                memberBoxes[k].min[axis] = 1e300;
+                memberBoxes[k].max[axis] = -1e300;
+            }
+            continue;
+        }
+        incidenceOffsets_[a + 1]++;
+        if (b != a) incidenceOffsets_[b + 1]++;
+        const double pa[3] = { c.x[a], c.y[a], c.z[a] };
+        const double pb[3] = { c.x[b], c.y[b], c.z[b] };
+        for (int axis = 0; axis < 3; ++axis) {
+            memberBoxes[k].min[axis] = min(pa[axis], pb[axis]);
+            memberBoxes[k].max[axis] = max(pa[axis], pb[axis]);
+        }
+    }
+    members_.Build(move(memberBoxes));
+
+    for (size_t j = 0; j < jointCount; ++j) incidenceOffsets_[j + 1] += incidenceOffsets_[j];
+    incidence_.resize(incidenceOffsets_[jointCount]);
+    vector<uint32_t> fill(incidenceOffsets_.begin(), incidenceOffsets_.end() - 1);
+    for (uint32_t k = 0; k < memberCount; ++k) {
+        uint32_t a = memberEnds_[2 * k], b = memberEnds_[2 * k + 1];
+        if (a == kNone || b == kNone) continue;
+        incidence_[fill[a]++] = k;
+        if (b != a) incidence_[fill[b]++] = k;
+    }
+}
+
+// Slab test of the member segment against the box
+bool ModelIndex::SegmentHitsBox(uint32_t member, const BoundingBox& box) const {
+    const auto& c = model_.coordinates;
+    uint32_t a = memberEnds_[2 * member], b = memberEnds_[2 * member + 1];
+    const double p[3] = { c.x[a], c.y[a], c.z[a] };
+    const double d[3] = { c.x[b] - c.x[a], c.y[b] - c.y[a], c.z[b] - c.z[a] };
+    double t0 = 0.0, t1 = 1.0;
+    for (int axis = 0; axis < 3; ++axis) {
+        if (d[axis] == 0.0) {
+            if (p[axis] < box.min[axis] || p[axis] > box.max[axis]) return false;
+            continue;
+        }
+        double ta = (box.min[axis] - p[axis]) / d[axis];
+        double tb = (box.max[axis] - p[axis]) / d[axis];
+        if (ta > tb) swap(ta, tb);
+        t0 = max(t0, ta);
+        t1 = min(t1, tb);
+        if (t0 > t1) return false;
+    }
+    return true;
+}
+
+Selection ModelIndex::Select(const FilterOptions& options) const {
+    auto started = chrono::steady_clock::now();
+    const size_t jointCount = model_.nodes.size();
+    const size_t beamCount = model_.beams.size();
+    const size_t memberCount = memberEnds_.size() / 2;
+
+    Selection selection;
+    selection.joints.assign(jointCount, 0);
+    selection.members.assign(memberCount, 0);
+
+    vector<uint32_t> hits;
+    if (options.useBox) {
+        joints_.Query(options.box, hits);
+        for (uint32_t j : hits) selection.joints[j] = 1;
+        hits.clear();
+        members_.Query(options.box, hits);
+        for (uint32_t k : hits) {
+            if (SegmentHitsBox(k, options.box)) selection.members[k] = 1;
+        }
+    }
+
+    for (const auto& name : options.groups) {
+        auto it = find(model_.groupNames.begin(), model_.groupNames.end(), name);
+        if (it == model_.groupNames.end()) {
+            cerr << "Warning: group " << name << " not found" << endl;
+            continue;
+        }
+        uint32_t group = static_cast<uint32_t>(it - model_.groupNames.begin());
+        for (const auto& assignment : model_.groups) {
+            if (assignment.group != group) continue;
+            uint32_t index;
+            switch (assignment.type) {
+            case GroupObject::Joint:
+                index = jointByLabel_[assignment.label];
+                if (index != kNone) selection.joints[index] = 1;
+                break;
+            case GroupObject::Frame:
+                index = memberByLabel_[0][assignment.label];
+                if (index != kNone) selection.members[index] = 1;
+                break;
+            case GroupObject::Cable:
+                index = memberByLabel_[1][assignment.label];
+                if (index != kNone) selection.members[beamCount + index] = 1;
+                break;
+            default:
+                break;
+            }
+        }
+    }
+
+    // Selected members always bring their joints along. A group can name a
+    // member whose joint is missing; validation reports it later.
+    vector<uint32_t> frontier;
+    for (uint32_t k = 0; k < memberCount; ++k) {
+        if (!selection.members[k]) continue;
+        for (int e = 0; e < 2; ++e) {
+            uint32_t j = memberEnds_[2 * k + e];
+            if (j != kNone) selection.joints[j] = 1;
+        }
+    }
+    for (uint32_t j = 0; j < jointCount; ++j) {
+        if (selection.joints[j]) frontier.push_back(j);
+    }
+
+    // N-hop neighbourhood over member incidence
+    vector<uint32_t> next;
+    for (int hop = 0; hop < options.hops && !frontier.empty(); ++hop) {
+        next.clear();
+        for (uint32_t j : frontier) {
+            for (uint32_t e = incidenceOffsets_[j]; e < incidenceOffsets_[j + 1]; ++e) {
+                uint32_t k = incidence_[e];
+                selection.members[k] = 1;
+                uint32_t other = memberEnds_[2 * k] == j ? memberEnds_[2 * k + 1] : memberEnds_[2 * k];
+                if (other != kNone && !selection.joints[other]) {
+                    selection.joints[other] = 1;
+                    next.push_back(other);
+                }
+            }
+        }
+        frontier.swap(next);
+    }
+
+    for (uint32_t j = 0; j < jointCount; ++j) {
+        if (!selection.joints[j]) continue;
+        selection.jointCount++;
+        for (uint32_t e = incidenceOffsets_[j]; e < incidenceOffsets_[j + 1]; ++e) {
+            if (!selection.members[incidence_[e]]) {
+                selection.boundary.push_back(j);
+                break;
+            }
+        }
+    }
+    for (uint8_t selected : selection.members) selection.memberCount += selected;
+
+    selection.milliseconds = chrono::duration<double, milli>(chrono::steady_clock::now() - started).count();
+    return selection;
+}
+
+void ConversionFilter::Apply(SAP2000Model& model, const Selection& selection) {
+    // A label is kept if any of its rows is
+    vector<uint8_t> keepLabel(model.jointLabels.size(), 0);
+    for (size_t j = 0; j < model.nodes.size(); ++j) keepLabel[model.nodes[j].sapId] |= selection.joints[j];
+    auto isKept = [&](uint32_t label) { return keepLabel[label] != 0; };
+
+    vector<uint8_t> keepRestraint(model.restraints.size());
+    for (size_t r = 0; r < model.restraints.size(); ++r) keepRestraint[r] = isKept(model.restraints[r].jointId);
+    vector<uint8_t> keepSpring(model.springs.size());
+    for (size_t s = 0; s < model.springs.size(); ++s) keepSpring[s] = isKept(model.springs[s].jointId);
+
+    const size_t beamCount = model.beams.size();
+    Compact(model.nodes, selection.joints);
+    Compact(model.coordinates.x, selection.joints);
+    Compact(model.coordinates.y, selection.joints);
+    Compact(model.coordinates.z, selection.joints);
+    Compact(model.beams, selection.members);
+    Compact(model.cables, selection.members, beamCount);
+    Compact(model.restraints, keepRestraint);
+    Compact(model.springs, keepSpring);
+}
+
+bool ConversionFilter::WriteBoundary(const SAP2000Model& model, const Selection& selection, const string& path) {
+    ofstream out(path);
+    if (!out.is_open()) {
+        cerr << "ERROR: Failed to write boundary joints: " << path << endl;
+        return false;
+    }
+    out << "# Selected joints connected to members outside the selection\n";
+    for (uint32_t j : selection.boundary) out << model.jointLabels.Text(model.nodes[j].sapId) << "\n";
+    return true;
+}
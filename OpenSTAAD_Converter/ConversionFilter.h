@@ -0,0 +1,49 @@
+#pragma once
+#include <string>
+#include <vector>
+#include "SAP2000Model.h"
+#include "SpatialIndex.h"
+
+struct FilterOptions {
+    bool useBox = false;
+    BoundingBox box;                  // Model units and axes, as in the .$2k
+    std::vector<std::string> groups;  // GROUPS 2 - ASSIGNMENTS names
+    int hops = 0;                     // Grow the selection by N member hops
+    bool IsActive() const { return useBox || !groups.empty(); }
+};
+
+struct Selection {
+    std::vector<uint8_t> joints;    // Per model.nodes
+    std::vector<uint8_t> members;   // Per beam, then per cable
+    std::vector<uint32_t> boundary; // Selected joints with unselected members
+    size_t jointCount = 0;
+    size_t memberCount = 0;
+    double milliseconds = 0.0;
+};
+
+// Spatial and topological index over a loaded model. Building it is linear;
+// each Select is a handful of tree and graph walks, so several regions can be
+// tried against the same index.
+class ModelIndex {
+public:
+    explicit ModelIndex(const SAP2000Model& model);
+    Selection Select(const FilterOptions& options) const;
+
+private:
+    bool SegmentHitsBox(uint32_t member, const BoundingBox& box) const;
+
+    const SAP2000Model& model_;
+    BoundingVolumeHierarchy joints_;
+    BoundingVolumeHierarchy members_;
+    std::vector<uint32_t> jointByLabel_;      // Joint label -> joint index
+    std::vector<uint32_t> memberByLabel_[2];  // Member label -> frame, cable index
+    std::vector<uint32_t> memberEnds_;        // 2 joint indices per member
+    std::vector<uint32_t> incidenceOffsets_;  // Joint -> members (CSR)
+    std::vector<uint32_t> incidence_;
+};
+
+namespace ConversionFilter {
+    // Keeps only the selected joints and members, with their restraints and springs.
+    void Apply(SAP2000Model& model, const Selection& selection);
+    bool WriteBoundary(const SAP2000Model& model, const Selection& selection, const std::string& path);
+}
@@ -0,0 +1,403 @@
+#include "ConversionPipeline.h"
+#include "StaadBackend.h"
+#include "SAP2000Model.h"
+#include "Renumbering.h"
+#include "InputStream.h"
+#include "MemberOrientation.h"
+#include "LoadCombinations.h"
+#include "ModelVerifier.h"
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <sstream>
+#include <system_error>
+#ifdef _WIN32
+#define NOMINMAX
+#include <windows.h>
+#include <psapi.h>
+#pragma comment(lib, "psapi.lib")
+#else
+#include <sys/resource.h>
+#endif
+
+namespace fs = std::filesystem;
+using namespace std;
+
+namespace {
+    double MillisecondsSince(chrono::steady_clock::time_point start) {
+        return chrono::duration<double, milli>(chrono::steady_clock::now() - start).count();
+    }
+
+    size_t PeakMemoryMB() {
+#ifdef _WIN32
+        PROCESS_MEMORY_COUNTERS counters = {};
+        counters.cb = sizeof(counters);
+        if (!GetProcessMemoryInfo(GetCurrentProcess(), &counters, sizeof(counters))) return 0;
+        return counters.PeakWorkingSetSize / (1024 * 1024);
+#else
+        rusage usage = {};
+        if (getrusage(RUSAGE_SELF, &usage) != 0) return 0;
+#ifdef __APPLE__
+        return static_cast<size_t>(usage.ru_maxrss) / (1024 * 1024);
+#else
+        return static_cast<size_t>(usage.ru_maxrss) / 1024;
+#endif
+#endif
+    }
+}
+
+ConversionJob::ConversionJob() {
+#ifdef _WIN32
+    outputDir = R"(C:\temp)";
+#else
+    outputDir = "/tmp";
+#endif
+}
+
+bool SectionCache::Find(const string& filePath, SectionPositions& sections) const {
+    auto it = entries_.find(filePath);
+    if (it == entries_.end()) return false;
+    error_code ec;
+    uintmax_t size = fs::file_size(filePath, ec);
+    if (ec || size != it->second.size) return false;
+    auto modified = fs::last_write_time(filePath, ec);
+    if (ec || modified != it->second.modified) return false;
+    sections = it->second.sections;
+    return true;
+}
+
+void SectionCache::Store(const string& filePath, const SectionPositions& sections) {
+    error_code ec;
+    Entry entry;
+    entry.size = fs::file_size(filePath, ec);
+    if (ec) return;
+    entry.modified = fs::last_write_time(filePath, ec);
+    if (ec) return;
+    entry.sections = sections;
+    if (entries_.size() >= capacity_ && entries_.find(filePath) == entries_.end()) {
+        entries_.erase(entries_.begin());
+    }
+    entries_[filePath] = entry;
+}
+
+void ConversionPipeline::PrintOptions(ostream& out) {
+    out << "  --length-unit N   Rescale to STAAD length unit N (default: model units)\n"
+        << "  --force-unit N    Rescale to STAAD force unit N (default: model units)\n"
+        << "  --model-units L F Units of a file without PROGRAM CONTROL (default: ask)\n"
+        << "  --z-up            Keep SAP2000 Z-up axes instead of remapping to Y-up\n"
+        << "  --on-error P      Invalid members: drop (default), fix or abort\n"
+        << "  --renumber        Renumber joints and members to reduce the stiffness matrix profile\n"
+        << "  --box X0 Y0 Z0 X1 Y1 Z1  Convert only joints and members inside the box (SAP coordinates)\n"
+        << "  --group NAME      Convert only the objects of a SAP group (repeatable)\n"
+        << "  --hops N          Grow the box/group selection by N members\n"
+        << "  --flag-boundary   List selected joints that connect to unconverted members\n"
+        << "  --output-dir DIR  Where the .std and the reports go (default: " << ConversionJob().outputDir << ")\n"
+        << "  --priority N      Service queue priority, higher runs first (default: 0)\n";
+}
+
+bool ConversionPipeline::ParseArguments(const vector<string>& args, ConversionJob& job,
+    vector<string>& inputs, vector<string>& options, string& error) {
+    size_t argc = args.size();
+    for (size_t i = 0; i < argc; ++i) {
+        const string& arg = args[i];
+        size_t first = i;
+        if (arg == "--length-unit" && i + 1 < argc) {
+            job.transform.target.lengthUnit = atoi(args[++i].c_str());
+        }
+        else if (arg == "--force-unit" && i + 1 < argc) {
+            job.transform.target.forceUnit = atoi(args[++i].c_str());
+        }
+        else if (arg == "--model-units" && i + 2 < argc) {
+            job.modelUnits.lengthUnit = atoi(args[++i].c_str());
+            job.modelUnits.forceUnit = atoi(args[++i].c_str());
+            if (!job.modelUnits.IsValid()) {
+                error = "--model-units takes a length and a force unit, 0-7.";
+                return false;
+            }
+        }
+        else if (arg == "--z-up") {
+            job.transform.targetUp = UpAxis::Z;
+        }
+        else if (arg == "--renumber") {
+            job.renumber = true;
+        }
+        else if (arg == "--box" && i + 6 < argc) {
+            job.filter.useBox = true;
+            for (int c = 0; c < 3; ++c) job.filter.box.min[c] = atof(args[++i].c_str());
+            for (int c = 0; c < 3; ++c) job.filter.box.max[c] = atof(args[++i].c_str());
+            for (int c = 0; c < 3; ++c) {
+                if (job.filter.box.min[c] > job.filter.box.max[c]) std::swap(job.filter.box.min[c], job.filter.box.max[c]);
+            }
+        }
+        else if (arg == "--group" && i + 1 < argc) {
+            job.filter.groups.push_back(args[++i]);
+        }
+        else if (arg == "--hops" && i + 1 < argc) {
+            job.filter.hops = atoi(args[++i].c_str());
+        }
+        else if (arg == "--flag-boundary") {
+            job.flagBoundary = true;
+        }
+        else if (arg == "--on-error" && i + 1 < argc) {
+            const string& policy = args[++i];
+            if (policy == "drop") job.validation.policy = ValidationPolicy::Drop;
+            else if (policy == "fix") job.validation.policy = ValidationPolicy::Fix;
+            else if (policy == "abort") job.validation.policy = ValidationPolicy::Abort;
+            else {
+                error = "Unknown --on-error policy: " + policy;
+                return false;
+            }
+        }
+        else if (arg == "--output-dir" && i + 1 < argc) {
+            job.outputDir = args[++i];
+        }
+        else if (arg == "--priority" && i + 1 < argc) {
+            job.priority = atoi(args[++i].c_str());
+        }
+        else if (arg.rfind("--", 0) == 0) {
+            error = "Unknown option or missing value: " + arg;
+            return false;
+        }
+        else {
+            inputs.push_back(arg);
+            continue;
+        }
+        options.insert(options.end(), args.begin() + first, args.begin() + i + 1);
+    }
+    if ((job.transform.target.lengthUnit >= 0 || job.transform.target.forceUnit >= 0) &&
+        !job.transform.target.IsValid()) {
+        error = "--length-unit and --force-unit must be given together, 0-7.";
+        return false;
+    }
+    return true;
+}
+
+ConversionResult ConversionPipeline::Run(const ConversionJob& job, StaadBackend& backend,
+    const ProgressFn& progress, const UnitPromptFn& askUnits, SectionCache* cache) {
+    auto started = chrono::steady_clock::now();
+    ConversionResult result;
+    auto report = [&](const char* stage, int percent, const string& message) {
+        if (progress) progress(stage, percent, message);
+    };
+    auto fail = [&](const string& error) {
+        result.ok = false;
+        result.error = error;
+        return result;
+    };
+    auto metric = [&](const char* name, double value) {
+        result.metrics.emplace_back(name, value);
+    };
+
+    try {
+        // Betas are computed for the target axes, so the model must use them
+        if (!backend.SupportsUpAxis(job.transform.targetUp)) {
+            return fail(string("--z-up is not supported by the ") + backend.Name() +
+                " backend; use --backend file");
+        }
+        fs::path filePath = fs::u8path(job.inputPath);
+        if (!fs::is_regular_file(filePath)) {
+            return fail("File not found: " + job.inputPath);
+        }
+        string parserPath = filePath.string();
+        // model.$2k.gz -> model
+        string modelName = filePath.stem().string();
+        if (InputStream::Detect(parserPath) != InputFormat::Plain) {
+            modelName = filePath.stem().stem().string();
+        }
+
+        fs::path outputDir = fs::u8path(job.outputDir);
+        error_code ec;
+        fs::create_directories(outputDir, ec);
+        if (!fs::is_directory(outputDir)) {
+            return fail("Failed to create output directory at " + job.outputDir);
+        }
+
+        report("parse", 0, "Processing file: " + job.inputPath);
+        auto parseStart = chrono::steady_clock::now();
+        InputText text;
+        if (!text.Load(parserPath)) {
+            return fail("Failed to read file: " + job.inputPath);
+        }
+        SectionPositions sections;
+        bool cached = cache != nullptr && cache->Find(parserPath, sections);
+        if (!cached) {
+            sections = SAP2000Parser::ParseFile(text);
+            if (cache != nullptr && sections.ijoint > 0) cache->Store(parserPath, sections);
+        }
+        SAP2000Model model(sections);
+        model.Load(text);
+        text.Release();
+        metric("parse_ms", MillisecondsSince(parseStart));
+        metric("section_scan_cached", cached ? 1 : 0);
+        metric("joints", static_cast<double>(model.nodes.size()));
+        metric("members", static_cast<double>(model.beams.size() + model.cables.size()));
+        report("parse", 20, "Peak working set: " + to_string(PeakMemoryMB()) + " MB");
+
+        if (job.filter.IsActive()) {
+            ModelIndex index(model);
+            Selection selection = index.Select(job.filter);
+            ostringstream summary;
+            summary << "Selected " << selection.jointCount << " joints and " << selection.memberCount
+                << " members in " << selection.milliseconds << " ms, "
+                << selection.boundary.size() << " boundary joint(s)";
+            report("filter", 25, summary.str());
+            if (job.flagBoundary) {
+                fs::path boundaryPath = outputDir / (modelName + "_boundary.txt");
+                if (ConversionFilter::WriteBoundary(model, selection, boundaryPath.string())) {
+                    report("filter", 25, "Boundary joints: " + boundaryPath.u8string());
+                }
+            }
+            ConversionFilter::Apply(model, selection);
+        }
+
+        if (model.errors.Total() > 0) {
+            metric("parse_errors", static_cast<double>(model.errors.Total()));
+            fs::path reportPath = outputDir / (modelName + "_parse_errors.txt");
+            if (model.errors.WriteReport(reportPath.string())) {
+                report("parse", 25, "Parse error report: " + reportPath.u8string());
+            }
+        }
+
+        // Units come from PROGRAM CONTROL; only ask when the table is missing
+        if (!model.units.IsValid() && job.modelUnits.IsValid()) {
+            model.units = job.modelUnits;
+        }
+        if (!model.units.IsValid() && !(askUnits && askUnits(model.units))) {
+            return fail("Model units unknown: the file has no PROGRAM CONTROL table (use --model-units)");
+        }
+        if (!UnitTransform::Apply(model, job.transform)) {
+            return fail("Could not bring the model to the requested units");
+        }
+        report("units", 30, string());
+
+        // Before validation, which may drop or renumber members
+        MemberOrientation::Apply(model);
+        report("orient", 35, string());
+
+        // Catch bad references before the first backend call
+        ValidationReport validationReport;
+        bool valid = ModelValidator::Validate(model, job.validation, validationReport);
+        ostringstream validationSummary;
+        validationSummary << "Validation:\n";
+        validationReport.PrintSummary(validationSummary);
+        report("validate", 40, validationSummary.str());
+        metric("validation_issues", static_cast<double>(validationReport.Total()));
+        if (validationReport.Total() + validationReport.renumberedMembers > 0) {
+            fs::path reportPath = outputDir / (modelName + "_validation.txt");
+            if (validationReport.WriteReport(reportPath.string(), model)) {
+                report("validate", 40, "Validation report: " + reportPath.u8string());
+            }
+        }
+        if (!valid) {
+            return fail("Model has errors, conversion aborted (--on-error abort)");
+        }
+
+        if (job.renumber) {
+            Renumbering::Apply(model);
+            fs::path mapPath = outputDir / (modelName + "_renumbering.csv");
+            if (Renumbering::WriteMap(model, mapPath.string())) {
+                report("renumber", 45, "SAP to STAAD ID map: " + mapPath.u8string());
+            }
+        }
+        else if (model.jointLabels.AlphanumericCount() + model.frameLabels.AlphanumericCount() +
+            model.cableLabels.AlphanumericCount() + model.cableLabels.RenumberedCount() > 0 ||
+            validationReport.renumberedMembers > 0) {
+            // Some labels got generated STAAD numbers; keep the trace
+            fs::path mapPath = outputDir / (modelName + "_labels.csv");
+            if (Renumbering::WriteMap(model, mapPath.string())) {
+                report("renumber", 45, "SAP label to STAAD ID map: " + mapPath.u8string());
+            }
+        }
+
+        CombinationReport combinationReport;
+        CombinationMatrix combinations = LoadCombinations::Flatten(model, combinationReport);
+        if (combinationReport.defined > 0) {
+            ostringstream summary;
+            summary << "Load combinations:\n";
+            combinationReport.PrintSummary(summary);
+            report("combinations", 50, summary.str());
+        }
+        if (combinationReport.emitted < combinationReport.defined) {
+            // Some names have no load of their own; say where their results are
+            fs::path mapPath = outputDir / (modelName + "_combinations.csv");
+            if (LoadCombinations::WriteMap(model, combinations, mapPath.string())) {
+                report("combinations", 50, "SAP combination to STAAD load map: " + mapPath.u8string());
+            }
+        }
+
+        fs::path outputPath = outputDir / (modelName + ".std");
+        auto createStart = chrono::steady_clock::now();
+        report("backend", 55, string("Creating the model through the ") + backend.Name() + " backend");
+        if (!backend.NewModel(outputPath.u8string(), model.units, model.upAxis)) {
+            return fail("Failed to start a new STAAD model");
+        }
+
+        // Missing geometry fails the job, but the model is still saved and
+        // verified so the report shows what is missing
+        string geometryError;
+        if (!backend.CreateNodes(model.nodes)) {
+            geometryError = "Failed to create nodes";
+            report("nodes", 60, geometryError);
+        }
+        if (!backend.CreateBeams(model.beams)) {
+            if (geometryError.empty()) geometryError = "Failed to create beams";
+            report("members", 65, "Failed to create beams");
+        }
+        if (!backend.CreateCables(model.cables)) {
+            if (geometryError.empty()) geometryError = "Failed to create cables";
+            report("members", 70, "Failed to create cables");
+        }
+        if (!backend.CreateSupports(model.restraints, model.springs)) {
+            report("supports", 75, "Failed to create supports");
+        }
+        if (!backend.AssignBetaAngles(model.beams)) {
+            report("properties", 80, "Failed to assign beta angles");
+        }
+        if (!backend.AssignMemberOffsets(model.insertions, model.beams)) {
+            report("properties", 80, "Failed to assign member offsets");
+        }
+        if (!backend.CreateLoadCombinations(model.patternNames, model.comboNames, combinations)) {
+            report("loads", 85, "Failed to create load combinations");
+        }
+        if (!backend.Save()) {
+            return fail("Failed to save " + outputPath.u8string());
+        }
+        metric("create_ms", MillisecondsSince(createStart));
+        report("save", 90, string());
+
+        // Read the geometry back from the saved input file, all at once
+        StdGeometry createdGeometry;
+        if (ModelVerifier::ReadStdFile(outputPath.string(), createdGeometry)) {
+            VerificationReport verification;
+            bool matches = ModelVerifier::Compare(model, createdGeometry, VerificationOptions(), verification);
+            ostringstream summary;
+            summary << "Verification:\n";
+            verification.PrintSummary(summary);
+            report("verify", 95, summary.str());
+            metric("mismatches", static_cast<double>(verification.Total()));
+            if (!matches) {
+                fs::path reportPath = outputDir / (modelName + "_verification.txt");
+                if (verification.WriteReport(reportPath.string())) {
+                    report("verify", 95, "Verification report: " + reportPath.u8string());
+                }
+            }
+        }
+
+        metric("arena_kb", static_cast<double>(model.Allocations().PeakBytes() / 1024));
+        model.Release();
+        metric("peak_memory_mb", static_cast<double>(PeakMemoryMB()));
+        metric("total_ms", MillisecondsSince(started));
+
+        result.outputPath = outputPath.u8string();
+        if (!geometryError.empty()) {
+            return fail(geometryError + " in " + result.outputPath);
+        }
+        result.ok = true;
+        report("done", 100, "Peak working set: " + to_string(PeakMemoryMB()) + " MB\n" +
+            "Conversion complete! Saved to: " + result.outputPath);
+    }
+    catch (const std::exception& e) {
+        return fail(string("Error: ") + e.what());
+    }
+    return result;
+}
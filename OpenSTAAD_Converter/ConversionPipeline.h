@@ -0,0 +1,73 @@
+#pragma once
+#include <cstdint>
+#include <filesystem>
+#include <functional>
+#include <iosfwd>
+#include <map>
+#include <string>
+#include <utility>
+#include <vector>
+#include "SAP2000Parser.h"
+#include "UnitTransform.h"
+#include "ModelValidator.h"
+#include "ConversionFilter.h"
+
+class StaadBackend;
+
+// Everything one conversion needs besides the backend
+struct ConversionJob {
+    std::string inputPath;  // UTF-8
+    std::string outputDir;  // UTF-8, created if missing
+    UnitSystem modelUnits;  // For files without PROGRAM CONTROL, instead of asking
+    TransformOptions transform;
+    ValidationOptions validation;
+    FilterOptions filter;
+    bool renumber = false;
+    bool flagBoundary = false;
+    int priority = 0;       // Service queue order, higher first
+    ConversionJob();
+};
+
+struct ConversionResult {
+    bool ok = false;
+    std::string outputPath; // UTF-8
+    std::string error;
+    std::vector<std::pair<std::string, double>> metrics; // Name, value
+};
+
+// Called at each stage with the overall percentage and a text line for the user
+typedef std::function<void(const char* stage, int percent, const std::string& message)> ProgressFn;
+// Asks for the model units when PROGRAM CONTROL is missing; false to give up
+typedef std::function<bool(UnitSystem& units)> UnitPromptFn;
+
+// Section positions of files already scanned, checked against the file size
+// and modification time, so a resubmitted file skips the first pass.
+class SectionCache {
+public:
+    explicit SectionCache(size_t capacity = 64) : capacity_(capacity) {}
+    bool Find(const std::string& filePath, SectionPositions& sections) const;
+    void Store(const std::string& filePath, const SectionPositions& sections);
+private:
+    struct Entry {
+        uintmax_t size;
+        std::filesystem::file_time_type modified;
+        SectionPositions sections;
+    };
+    size_t capacity_;
+    std::map<std::string, Entry> entries_;
+};
+
+namespace ConversionPipeline {
+    // Reads conversion options from command line arguments. Input paths go to
+    // `inputs`, the remaining arguments to `options` so a client can forward
+    // them with each path. False with a message on a bad option.
+    bool ParseArguments(const std::vector<std::string>& args, ConversionJob& job,
+        std::vector<std::string>& inputs, std::vector<std::string>& options, std::string& error);
+    void PrintOptions(std::ostream& out);
+    // Parse, filter, transform, validate, renumber and flatten the model, build
+    // it through the backend and verify the saved .std. Reports go next to the
+    // output; failures come back in the result instead of ending the process.
+    ConversionResult Run(const ConversionJob& job, StaadBackend& backend,
+        const ProgressFn& progress, const UnitPromptFn& askUnits = nullptr,
+        SectionCache* cache = nullptr);
+}
@@ -0,0 +1,294 @@
+#include "ConversionService.h"
+#include "StaadBackend.h"
+#include <algorithm>
+#include <iostream>
+#include <sstream>
+#include <thread>
+
+using namespace std;
+
+namespace {
+    vector<string> SplitFields(const string& line) {
+        vector<string> fields;
+        size_t start = 0;
+        for (;;) {
+            size_t tab = line.find('\t', start);
+            fields.push_back(line.substr(start, tab == string::npos ? string::npos : tab - start));
+            if (tab == string::npos) break;
+            start = tab + 1;
+        }
+        return fields;
+    }
+
+    const string& Field(const vector<string>& fields, size_t k) {
+        static const string empty;
+        return k < fields.size() ? fields[k] : empty;
+    }
+
+    // Free text inside one field
+    string Clean(string text) {
+        replace(text.begin(), text.end(), '\t', ' ');
+        replace(text.begin(), text.end(), '\n', ' ');
+        replace(text.begin(), text.end(), '\r', ' ');
+        return text;
+    }
+
+    // True when a runs before b: higher priority, then lower (older) id
+    struct Later {
+        template <typename Job>
+        bool operator()(const Job& a, const Job& b) const {
+            return a.priority != b.priority ? a.priority < b.priority : a.id > b.id;
+        }
+    };
+}
+
+ConversionService::ConversionService(StaadBackend& backend, const string& endpoint)
+    : backend_(backend), endpoint_(endpoint) {
+}
+
+int ConversionService::Run() {
+    if (!backend_.Open()) {
+        cerr << "Failed to open the " << backend_.Name() << " backend" << endl;
+        return 1;
+    }
+    if (!listener_.Listen(endpoint_)) {
+        return 1;
+    }
+    cout << "Conversion service listening on " << LocalChannel::Address(endpoint_)
+        << " (" << backend_.Name() << " backend)" << endl;
+
+    thread acceptor(&ConversionService::AcceptClients, this);
+    unique_lock<mutex> lock(mutex_);
+    for (;;) {
+        wake_.wait(lock, [this] { return stopping_ || !queue_.empty(); });
+        if (stopping_) break;
+        pop_heap(queue_.begin(), queue_.end(), Later());
+        QueuedJob queued = move(queue_.back());
+        queue_.pop_back();
+        running_ = queued.id;
+        lock.unlock();
+
+        RunJob(queued);
+        lock.lock();
+    }
+
+    for (const auto& queued : queue_) {
+        queued.client->WriteLine("FAILED\t" + to_string(queued.id) + "\tService shutting down");
+    }
+    queue_.clear();
+    lock.unlock();
+
+    listener_.Close();
+    acceptor.join();
+
+    // Client threads end once their connection closes
+    lock.lock();
+    for (const auto& weak : clients_) {
+        if (auto client = weak.lock()) client->Close();
+    }
+    wake_.wait(lock, [this] { return activeClients_ == 0; });
+    cout << "Conversion service stopped after " << finished_ << " job(s), "
+        << failed_ << " failed" << endl;
+    return 0;
+}
+
+void ConversionService::Stop() {
+    lock_guard<mutex> lock(mutex_);
+    stopping_ = true;
+    wake_.notify_all();
+}
+
+void ConversionService::AcceptClients() {
+    while (auto connection = listener_.Accept()) {
+        shared_ptr<LocalConnection> client(move(connection));
+        lock_guard<mutex> lock(mutex_);
+        if (stopping_) break;
+        clients_.erase(remove_if(clients_.begin(), clients_.end(),
+            [](const weak_ptr<LocalConnection>& weak) { return weak.expired(); }), clients_.end());
+        clients_.push_back(client);
+        ++activeClients_;
+        thread(&ConversionService::ServeClient, this, client).detach();
+    }
+}
+
+void ConversionService::ServeClient(shared_ptr<LocalConnection> client) {
+    string line;
+    while (client->ReadLine(line)) {
+        vector<string> fields = SplitFields(line);
+        const string& command = fields[0];
+        if (command == "JOB") {
+            ConversionJob job;
+            vector<string> args(fields.begin() + 1, fields.end());
+            vector<string> inputs, options;
+            string error;
+            if (!ConversionPipeline::ParseArguments(args, job, inputs, options, error) || inputs.size() != 1) {
+                client->WriteLine("ERROR\t" + Clean(error.empty() ? "JOB takes exactly one input path" : error));
+                continue;
+            }
+            job.inputPath = inputs[0];
+
+            lock_guard<mutex> lock(mutex_);
+            if (stopping_) {
+                client->WriteLine("ERROR\tService shutting down");
+                continue;
+            }
+            size_t ahead = running_ != 0 ? 1 : 0;
+            for (const auto& queued : queue_) {
+                if (queued.priority >= job.priority) ++ahead;
+            }
+            uint64_t id = nextId_++;
+            int priority = job.priority;
+            queue_.push_back(QueuedJob{ priority, id, move(job), client });
+            push_heap(queue_.begin(), queue_.end(), Later());
+            // Under the lock, so QUEUED always comes before STARTED
+            client->WriteLine("QUEUED\t" + to_string(id) + "\t" + to_string(ahead));
+            wake_.notify_all();
+        }
+        else if (command == "STATUS") {
+            lock_guard<mutex> lock(mutex_);
+            client->WriteLine("STATUS\t" + to_string(queue_.size()) + "\t" + to_string(running_) + "\t" +
+                to_string(finished_) + "\t" + to_string(failed_) + (stopping_ ? "\tstopping" : ""));
+        }
+        else if (command == "SHUTDOWN") {
+            client->WriteLine("BYE");
+            Stop();
+        }
+        else if (!command.empty()) {
+            client->WriteLine("ERROR\tUnknown command " + Clean(command));
+        }
+    }
+
+    // Jobs nobody is waiting for any more
+    lock_guard<mutex> lock(mutex_);
+    size_t before = queue_.size();
+    queue_.erase(remove_if(queue_.begin(), queue_.end(),
+        [&](const QueuedJob& queued) { return queued.client == client; }), queue_.end());
+    make_heap(queue_.begin(), queue_.end(), Later());
+    if (queue_.size() < before) {
+        cout << "Client disconnected, dropped " << before - queue_.size() << " queued job(s)" << endl;
+    }
+    client.reset();
+    --activeClients_;
+    wake_.notify_all();
+}
+
+void ConversionService::RunJob(const QueuedJob& queued) {
+    LocalConnection& client = *queued.client;
+    const string id = to_string(queued.id);
+    cout << "[" << id << "] " << queued.job.inputPath << endl;
+    client.WriteLine("STARTED\t" + id + "\t" + Clean(queued.job.inputPath));
+
+    ProgressFn progress = [&](const char* stage, int percent, const string& message) {
+        string prefix = "PROGRESS\t" + id + "\t" + to_string(percent) + "\t" + stage + "\t";
+        istringstream lines(message);
+        string text;
+        bool sent = false;
+        while (getline(lines, text)) {
+            if (text.empty()) continue;
+            client.WriteLine(prefix + Clean(text));
+            sent = true;
+        }
+        if (!sent) client.WriteLine(prefix);
+    };
+    ConversionResult result = ConversionPipeline::Run(queued.job, backend_, progress, nullptr, &cache_);
+
+    for (const auto& metric : result.metrics) {
+        ostringstream value;
+        value << metric.second;
+        client.WriteLine("METRIC\t" + id + "\t" + metric.first + "\t" + value.str());
+    }
+    // Counted before the reply, so a STATUS sent after it already sees the job finished
+    {
+        lock_guard<mutex> lock(mutex_);
+        ++(result.ok ? finished_ : failed_);
+        running_ = 0;
+    }
+    if (result.ok) {
+        client.WriteLine("DONE\t" + id + "\t" + Clean(result.outputPath));
+        cout << "[" << id << "] Saved to: " << result.outputPath << endl;
+    }
+    else {
+        client.WriteLine("FAILED\t" + id + "\t" + Clean(result.error));
+        cerr << "[" << id << "] " << result.error << endl;
+    }
+}
+
+int ConversionClient::Submit(const string& endpoint, const vector<string>& options,
+    const vector<string>& inputs) {
+    auto connection = LocalChannel::Connect(endpoint);
+    if (!connection) return 1;
+
+    for (const auto& input : inputs) {
+        string line = "JOB";
+        for (const auto& option : options) line += "\t" + Clean(option);
+        line += "\t" + Clean(input);
+        if (!connection->WriteLine(line)) {
+            cerr << "ERROR: Could not send the job for " << input << endl;
+            return 1;
+        }
+    }
+
+    size_t pending = inputs.size();
+    size_t failures = 0;
+    string line;
+    while (pending > 0 && connection->ReadLine(line)) {
+        vector<string> fields = SplitFields(line);
+        const string& kind = fields[0];
+        const string& id = Field(fields, 1);
+        if (kind == "QUEUED") {
+            cout << "[" << id << "] queued, " << Field(fields, 2) << " ahead" << endl;
+        }
+        else if (kind == "STARTED") {
+            cout << "[" << id << "] started: " << Field(fields, 2) << endl;
+        }
+        else if (kind == "PROGRESS") {
+            cout << "[" << id << "] " << Field(fields, 2) << "% " << Field(fields, 3);
+            if (!Field(fields, 4).empty()) cout << ": " << Field(fields, 4);
+            cout << endl;
+        }
+        else if (kind == "METRIC") {
+            cout << "[" << id << "] " << Field(fields, 2) << " = " << Field(fields, 3) << endl;
+        }
+        else if (kind == "DONE") {
+            cout << "[" << id << "] done: " << Field(fields, 2) << endl;
+            --pending;
+        }
+        else if (kind == "FAILED" || kind == "ERROR") {
+            // ERROR answers a JOB line the service could not queue
+            if (kind == "FAILED") cerr << "[" << id << "] failed: " << Field(fields, 2) << endl;
+            else cerr << "Service refused a job: " << id << endl;
+            ++failures;
+            --pending;
+        }
+    }
+    if (pending > 0) {
+        cerr << "ERROR: Lost the connection to the service with " << pending << " job(s) unfinished" << endl;
+        return 1;
+    }
+    return failures == 0 ? 0 : 1;
+}
+
+int ConversionClient::Command(const string& endpoint, const string& command) {
+    auto connection = LocalChannel::Connect(endpoint);
+    if (!connection) return 1;
+    string line;
+    if (!connection->WriteLine(command) || !connection->ReadLine(line)) {
+        cerr << "ERROR: No reply from the service" << endl;
+        return 1;
+    }
+    vector<string> fields = SplitFields(line);
+    if (fields[0] == "STATUS") {
+        cout << "Queued: " << Field(fields, 1) << ", running job: " << Field(fields, 2)
+            << ", finished: " << Field(fields, 3) << ", failed: " << Field(fields, 4);
+        if (!Field(fields, 5).empty()) cout << " (" << Field(fields, 5) << ")";
+        cout << endl;
+    }
+    else if (fields[0] == "BYE") {
+        cout << "Service stopping after the running job" << endl;
+    }
+    else {
+        cerr << "Service: " << Field(fields, 1) << endl;
+        return 1;
+    }
+    return 0;
+}
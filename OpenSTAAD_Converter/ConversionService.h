@@ -0,0 +1,67 @@
+#pragma once
+#include <condition_variable>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+#include "ConversionPipeline.h"
+#include "LocalChannel.h"
+
+class StaadBackend;
+
+// Conversion daemon. Clients connect over a LocalChannel and send one command
+// per line, fields separated by tabs:
+//   JOB <arg>...   options and one input path, as on the command line
+//   STATUS         queued, running and finished job counts
+//   SHUTDOWN       finish the running job, fail the queued ones and exit
+// Each job is answered with QUEUED <id> <ahead>, STARTED <id> <input>,
+// PROGRESS <id> <percent> <stage> <text>, METRIC <id> <name> <value> and
+// finally DONE <id> <output> or FAILED <id> <error>.
+//
+// Jobs run one at a time, highest priority first and in arrival order within
+// a priority, on the thread that called Run. That thread also opens the
+// backend, so the STAAD session and the section cache stay warm between jobs.
+class ConversionService {
+public:
+    ConversionService(StaadBackend& backend, const std::string& endpoint);
+    // Serves until a client sends SHUTDOWN. Returns the process exit code.
+    int Run();
+private:
+    struct QueuedJob {
+        int priority;
+        uint64_t id;
+        ConversionJob job;
+        std::shared_ptr<LocalConnection> client;
+    };
+
+    void AcceptClients();
+    void ServeClient(std::shared_ptr<LocalConnection> client);
+    void RunJob(const QueuedJob& queued);
+    void Stop();
+
+    StaadBackend& backend_;
+    std::string endpoint_;
+    LocalListener listener_;
+    SectionCache cache_;
+
+    std::mutex mutex_;
+    std::condition_variable wake_;
+    std::vector<QueuedJob> queue_; // Heap, highest priority and oldest on top
+    std::vector<std::weak_ptr<LocalConnection>> clients_;
+    size_t activeClients_ = 0;
+    uint64_t nextId_ = 1;
+    uint64_t running_ = 0;
+    size_t finished_ = 0;
+    size_t failed_ = 0;
+    bool stopping_ = false;
+};
+
+namespace ConversionClient {
+    // Sends one JOB per input with the shared options and prints the replies
+    // until every job has finished. Returns 0 when all of them succeeded.
+    int Submit(const std::string& endpoint, const std::vector<std::string>& options,
+        const std::vector<std::string>& inputs);
+    // STATUS or SHUTDOWN, printing the reply
+    int Command(const std::string& endpoint, const std::string& command);
+}
@@ -0,0 +1,535 @@
+#include "InputStream.h"
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <future>
+#include <iostream>
+#include <limits>
+#include <sstream>
+#include <streambuf>
+#include <thread>
+#include <vector>
+
+#if __has_include(<zlib.h>)
+#include <zlib.h>
+#define SAP2K_HAVE_ZLIB 1
+#ifdef _MSC_VER
+#pragma comment(lib, "zlib.lib")
+#endif
+#endif
+
+#if __has_include(<zstd.h>)
+#include <zstd.h>
+#include <zstd_errors.h>
+#define SAP2K_HAVE_ZSTD 1
+#ifdef _MSC_VER
+#pragma comment(lib, "zstd.lib")
+#endif
+#endif
+
+using namespace std;
+
+namespace {
+    const size_t kReadChunk = size_t(1) << 20;   // Compressed bytes per read
+    const size_t kOutputChunk = size_t(1) << 20; // Decompressed bytes per underflow
+    const size_t kBatchBytes = size_t(8) << 20;  // Compressed bytes per parallel batch
+    const size_t kProbeBytes = size_t(4) << 20;  // Start of the file checked for frames
+
+    // Shared get-area handling: derived classes produce the next piece of
+    // decompressed text into buffer_. Only the read position can be asked
+    // for, as the count of decoded bytes read so far.
+    class DecodingBuf : public streambuf {
+    protected:
+        virtual bool Fill(string& buffer) = 0;
+
+        int_type underflow() override {
+            if (gptr() < egptr()) return traits_type::to_int_type(*gptr());
+            consumed_ += egptr() - eback();
+            buffer_.clear();
+            while (buffer_.empty()) {
+                if (!Fill(buffer_)) return traits_type::eof();
+            }
+            char* begin = &buffer_[0];
+            setg(begin, begin, begin + buffer_.size());
+            return traits_type::to_int_type(*gptr());
+        }
+
+        pos_type seekoff(off_type offset, ios::seekdir way, ios::openmode which) override {
+            if (offset != 0 || way != ios::cur || !(which & ios::in)) return pos_type(off_type(-1));
+            return pos_type(static_cast<off_type>(consumed_ + (gptr() - eback())));
+        }
+
+        string buffer_;
+        uint64_t consumed_ = 0;
+    };
+
+    // Keeps the stream buffer alive; the istream base only borrows it.
+    class DecodingStream : public istream {
+    public:
+        explicit DecodingStream(shared_ptr<streambuf> buf)
+            : istream(buf.get()), buf_(std::move(buf)) {
+        }
+    private:
+        shared_ptr<streambuf> buf_;
+    };
+
+#ifdef SAP2K_HAVE_ZLIB
+    // Sequential gzip, including files made of several concatenated members.
+    // `head` is the start of the file, already read by the caller.
+    class GzipBuf : public DecodingBuf {
+    public:
+        GzipBuf(ifstream file, string head) : file_(move(file)), input_(move(head)) {
+            memset(&stream_, 0, sizeof(stream_));
+            stream_.next_in = reinterpret_cast<Bytef*>(&input_[0]);
+            stream_.avail_in = static_cast<uInt>(input_.size());
+            ok_ = inflateInit2(&stream_, 15 + 16) == Z_OK;
+        }
+        ~GzipBuf() override { inflateEnd(&stream_); }
+
+    protected:
+        bool Fill(string& buffer) override {
+            if (!ok_) return false;
+            buffer.resize(kOutputChunk);
+            stream_.next_out = reinterpret_cast<Bytef*>(&buffer[0]);
+            stream_.avail_out = static_cast<uInt>(buffer.size());
+            while (stream_.avail_out > 0) {
+                if (stream_.avail_in == 0) {
+                    input_.resize(kReadChunk);
+                    file_.read(&input_[0], input_.size());
+                    stream_.avail_in = static_cast<uInt>(file_.gcount());
+                    stream_.next_in = reinterpret_cast<Bytef*>(input_.data());
+                    if (stream_.avail_in == 0) {
+                        if (inMember_) cerr << "ERROR: Truncated gzip input" << endl;
+                        ok_ = false;
+                        break;
+                    }
+                }
+                inMember_ = true;
+                int status = inflate(&stream_, Z_NO_FLUSH);
+                if (status == Z_STREAM_END) {
+                    inflateReset(&stream_); // Next member, if any
+                    inMember_ = false;
+                }
+                else if (status != Z_OK && status != Z_BUF_ERROR) {
+                    cerr << "ERROR: Corrupt gzip input" << endl;
+                    ok_ = false;
+                    break;
+                }
+            }
+            buffer.resize(buffer.size() - stream_.avail_out);
+            return !buffer.empty();
+        }
+
+    private:
+        ifstream file_;
+        string input_;
+        z_stream stream_;
+        bool ok_ = false;
+        bool inMember_ = false;
+    };
+#endif
+
+#ifdef SAP2K_HAVE_ZSTD
+    // Sequential zstd; frames follow each other transparently. `head` is the
+    // start of the file, already read by the caller.
+    class ZstdBuf : public DecodingBuf {
+    public:
+        ZstdBuf(ifstream file, string head)
+            : file_(move(file)), input_(move(head)), context_(ZSTD_createDCtx()) {
+            in_ = { input_.data(), input_.size(), 0 };
+        }
+        ~ZstdBuf() override { ZSTD_freeDCtx(context_); }
+
+    protected:
+        bool Fill(string& buffer) override {
+            buffer.resize(kOutputChunk);
+            ZSTD_outBuffer out = { &buffer[0], buffer.size(), 0 };
+            while (out.pos < out.size) {
+                if (in_.pos == in_.size) {
+                    input_.resize(ZSTD_DStreamInSize());
+                    file_.read(&input_[0], input_.size());
+                    in_ = { input_.data(), static_cast<size_t>(file_.gcount()), 0 };
+                    if (in_.size == 0) {
+                        if (pending_ != 0) cerr << "ERROR: Truncated zstd input" << endl;
+                        pending_ = 0;
+                        break;
+                    }
+                }
+                size_t status = ZSTD_decompressStream(context_, &out, &in_);
+                pending_ = status;
+                if (ZSTD_isError(status)) {
+                    cerr << "ERROR: Corrupt zstd input: " << ZSTD_getErrorName(status) << endl;
+                    in_ = { nullptr, 0, 0 };
+                    file_.setstate(ios::eofbit);
+                    break;
+                }
+            }
+            buffer.resize(out.pos);
+            return !buffer.empty();
+        }
+
+    private:
+        ifstream file_;
+        string input_;
+        ZSTD_DCtx* context_;
+        ZSTD_inBuffer in_ = { nullptr, 0, 0 };
+        size_t pending_ = 0; // Nonzero while a frame is incomplete
+    };
+#endif
+
+#if defined(SAP2K_HAVE_ZLIB) || defined(SAP2K_HAVE_ZSTD)
+    // Splits the compressed file into independent frames (bgzip blocks or
+    // zstd frames), decodes each batch of frames on all cores and keeps the
+    // next batch decoding while the current one is being read. `head` is the
+    // file from frame `start` on, already read by the caller. With `frames`,
+    // frame starts about every kOutputChunk of text are stored there when
+    // the stream is destroyed.
+    class ParallelFrameBuf : public DecodingBuf {
+    public:
+        ParallelFrameBuf(ifstream file, InputFormat format, string head,
+            InputText::FrameOffset start, vector<InputText::FrameOffset>* frames)
+            : file_(move(file)), format_(format), carry_(move(head)), next_(start), frames_(frames) {
+            consumed_ = start.decoded; // Read positions count from the file start
+            pending_ = async(launch::async, [this] { return NextBatch(); });
+        }
+        ~ParallelFrameBuf() override {
+            if (pending_.valid()) pending_.wait();
+            if (frames_) *frames_ = move(recorded_);
+        }
+
+    protected:
+        bool Fill(string& buffer) override {
+            if (!pending_.valid()) return false;
+            buffer = pending_.get();
+            if (buffer.empty()) return false;
+            pending_ = async(launch::async, [this] { return NextBatch(); });
+            return true;
+        }
+
+    private:
+        // Size of the complete frame at the start of data, 0 if more input
+        // is needed, SIZE_MAX if the data is not a frame.
+        size_t FrameSize(const char* data, size_t size) const {
+            if (format_ == InputFormat::Gzip) {
+                // BGZF: FEXTRA subfield "BC" holds the block size minus one
+                if (size < 18) return 0;
+                const uint8_t* p = reinterpret_cast<const uint8_t*>(data);
+                if (p[0] != 0x1f || p[1] != 0x8b || !(p[3] & 4)) return SIZE_MAX;
+                size_t extraLength = p[10] | (p[11] << 8);
+                if (size < 12 + extraLength) return 0;
+                for (size_t i = 12; i + 4 <= 12 + extraLength;) {
+                    size_t fieldLength = p[i + 2] | (p[i + 3] << 8);
+                    if (p[i] == 'B' && p[i + 1] == 'C' && fieldLength == 2) {
+                        size_t blockSize = (p[i + 4] | (p[i + 5] << 8)) + size_t(1);
+                        return blockSize <= size ? blockSize : 0;
+                    }
+                    i += 4 + fieldLength;
+                }
+                return SIZE_MAX;
+            }
+#ifdef SAP2K_HAVE_ZSTD
+            size_t frameSize = ZSTD_findFrameCompressedSize(data, size);
+            if (!ZSTD_isError(frameSize)) return frameSize;
+            return ZSTD_getErrorCode(frameSize) == ZSTD_error_srcSize_wrong ? 0 : SIZE_MAX;
+#else
+            return SIZE_MAX;
+#endif
+        }
+
+        static bool DecodeFrame(InputFormat format, const char* data, size_t size, string& out) {
+#ifdef SAP2K_HAVE_ZLIB
+            if (format == InputFormat::Gzip) {
+                // ISIZE trailer gives the exact output size
+                const uint8_t* tail = reinterpret_cast<const uint8_t*>(data + size - 4);
+                out.resize(tail[0] | (tail[1] << 8) | (tail[2] << 16) | (size_t(tail[3]) << 24));
+                z_stream stream;
+                memset(&stream, 0, sizeof(stream));
+                if (inflateInit2(&stream, 15 + 16) != Z_OK) return false;
+                stream.next_in = reinterpret_cast<Bytef*>(const_cast<char*>(data));
+                stream.avail_in = static_cast<uInt>(size);
+                Bytef empty = 0; // zlib rejects a null output even for the empty EOF block
+                stream.next_out = out.empty() ? &empty : reinterpret_cast<Bytef*>(&out[0]);
+                stream.avail_out = static_cast<uInt>(out.size());
+                int status = inflate(&stream, Z_FINISH);
+                inflateEnd(&stream);
+                return status == Z_STREAM_END;
+            }
+#endif
+#ifdef SAP2K_HAVE_ZSTD
+            if (format == InputFormat::Zstd) {
+                unsigned long long contentSize = ZSTD_getFrameContentSize(data, size);
+                if (contentSize != ZSTD_CONTENTSIZE_UNKNOWN && contentSize != ZSTD_CONTENTSIZE_ERROR) {
+                    out.resize(static_cast<size_t>(contentSize));
+                    size_t written = ZSTD_decompress(out.empty() ? nullptr : &out[0], out.size(), data, size);
+                    return !ZSTD_isError(written) && written == out.size();
+                }
+                // Streamed frame without a size in its header
+                ZSTD_DCtx* context = ZSTD_createDCtx();
+                ZSTD_inBuffer in = { data, size, 0 };
+                out.clear();
+                size_t status = 1;
+                while (status != 0) {
+                    size_t used = out.size();
+                    out.resize(used + kOutputChunk);
+                    ZSTD_outBuffer chunk = { &out[used], kOutputChunk, 0 };
+                    status = ZSTD_decompressStream(context, &chunk, &in);
+                    out.resize(used + chunk.pos);
+                    if (ZSTD_isError(status) || (in.pos == in.size && chunk.pos == 0 && status != 0)) {
+                        ZSTD_freeDCtx(context);
+                        return false;
+                    }
+                }
+                ZSTD_freeDCtx(context);
+                return true;
+            }
+#endif
+            (void)data; (void)size; (void)out;
+            return false;
+        }
+
+        // Runs on the read-ahead task; only one batch is in flight at a time,
+        // so file_, carry_ and the frame offsets are never touched concurrently.
+        string NextBatch() {
+            vector<pair<size_t, size_t>> frames; // Offset, size in carry_
+            size_t offset = 0;
+            while (offset < kBatchBytes) {
+                size_t frameSize = FrameSize(carry_.data() + offset, carry_.size() - offset);
+                if (frameSize == SIZE_MAX) {
+                    cerr << "ERROR: Unexpected data in compressed input" << endl;
+                    carry_.clear();
+                    return string();
+                }
+                if (frameSize == 0) {
+                    if (!file_) break;
+                    size_t used = carry_.size();
+                    carry_.resize(used + kReadChunk);
+                    file_.read(&carry_[used], kReadChunk);
+                    carry_.resize(used + static_cast<size_t>(file_.gcount()));
+                    continue;
+                }
+                frames.emplace_back(offset, frameSize);
+                offset += frameSize;
+                if (offset == carry_.size() && !file_) break;
+            }
+            if (frames.empty() && !carry_.empty()) {
+                cerr << "ERROR: Truncated compressed input" << endl;
+                carry_.clear();
+                return string();
+            }
+
+            vector<string> decoded(frames.size());
+            vector<uint8_t> ok(frames.size(), 0);
+            unsigned workers = max(1u, min<unsigned>(thread::hardware_concurrency(), static_cast<unsigned>(frames.size())));
+            vector<thread> threads;
+            for (unsigned w = 0; w < workers; ++w) {
+                threads.emplace_back([&, w] {
+                    for (size_t f = w; f < frames.size(); f += workers) {
+                        ok[f] = DecodeFrame(format_, carry_.data() + frames[f].first, frames[f].second, decoded[f]);
+                    }
+                });
+            }
+            for (auto& thread : threads) thread.join();
+
+            string text;
+            size_t total = 0;
+            for (const auto& part : decoded) total += part.size();
+            text.reserve(total);
+            for (size_t f = 0; f < frames.size(); ++f) {
+                if (!ok[f]) {
+                    cerr << "ERROR: Corrupt frame in compressed input" << endl;
+                    carry_.clear();
+                    return text;
+                }
+                if (frames_ && (recorded_.empty() || next_.decoded - recorded_.back().decoded >= kOutputChunk)) {
+                    recorded_.push_back({ next_.compressed + frames[f].first, next_.decoded });
+                }
+                next_.decoded += decoded[f].size();
+                text += decoded[f];
+            }
+            carry_.erase(0, offset);
+            next_.compressed += offset;
+            return text;
+        }
+
+        ifstream file_;
+        InputFormat format_;
+        string carry_;
+        InputText::FrameOffset next_; // Start of carry_ and of its text
+        vector<InputText::FrameOffset>* frames_;
+        vector<InputText::FrameOffset> recorded_;
+        future<string> pending_;
+    };
+
+    // True when the first frame in `head` is complete and independent, i.e.
+    // the file can be split into frames without decoding it (bgzip,
+    // multi-frame zstd) and this build has the codec for it.
+    bool IsFramed(const string& head, bool moreInput, InputFormat format) {
+#ifdef SAP2K_HAVE_ZLIB
+        if (format == InputFormat::Gzip) {
+            if (head.size() < 18 || !(static_cast<uint8_t>(head[3]) & 4)) return false;
+            return head[12] == 'B' && head[13] == 'C';
+        }
+#endif
+#ifdef SAP2K_HAVE_ZSTD
+        if (format == InputFormat::Zstd) {
+            size_t frameSize = ZSTD_findFrameCompressedSize(head.data(), head.size());
+            return !ZSTD_isError(frameSize) && (frameSize < head.size() || moreInput);
+        }
+#endif
+        (void)head; (void)moreInput; (void)format;
+        return false;
+    }
+#endif
+}
+
+InputFormat InputStream::Detect(const string& filePath) {
+    ifstream file(filePath, ios::binary);
+    unsigned char magic[4] = {};
+    file.read(reinterpret_cast<char*>(magic), 4);
+    if (file.gcount() >= 2 && magic[0] == 0x1f && magic[1] == 0x8b) return InputFormat::Gzip;
+    if (file.gcount() == 4 && magic[0] == 0x28 && magic[1] == 0xb5 && magic[2] == 0x2f && magic[3] == 0xfd) {
+        return InputFormat::Zstd;
+    }
+    return InputFormat::Plain;
+}
+
+namespace {
+    // Decoder over a compressed file from the frame at `start`, which is the
+    // file start unless it came from a recorded frame offset.
+    shared_ptr<streambuf> OpenDecoder(const string& filePath, InputFormat format,
+        InputText::FrameOffset start, vector<InputText::FrameOffset>* frames) {
+        ifstream file(filePath, ios::binary);
+        if (!file.is_open()) return nullptr;
+        file.seekg(static_cast<streamoff>(start.compressed));
+
+        // The probe is read once and handed to the decoder as its first input
+        string head(kProbeBytes, '\0');
+        file.read(&head[0], head.size());
+        head.resize(static_cast<size_t>(file.gcount()));
+
+#if defined(SAP2K_HAVE_ZLIB) || defined(SAP2K_HAVE_ZSTD)
+        if (start.compressed > 0 || IsFramed(head, !file.eof(), format)) {
+            return make_shared<ParallelFrameBuf>(move(file), format, move(head), start, frames);
+        }
+#endif
+#ifdef SAP2K_HAVE_ZLIB
+        if (format == InputFormat::Gzip) {
+            return make_shared<GzipBuf>(move(file), move(head));
+        }
+#endif
+#ifdef SAP2K_HAVE_ZSTD
+        if (format == InputFormat::Zstd) {
+            return make_shared<ZstdBuf>(move(file), move(head));
+        }
+#endif
+        (void)frames;
+        cerr << "ERROR: " << (format == InputFormat::Gzip ? "gzip" : "zstd")
+            << " input is not supported by this build" << endl;
+        return nullptr;
+    }
+
+    bool CodecAvailable(InputFormat format) {
+#ifdef SAP2K_HAVE_ZLIB
+        if (format == InputFormat::Gzip) return true;
+#endif
+#ifdef SAP2K_HAVE_ZSTD
+        if (format == InputFormat::Zstd) return true;
+#endif
+        return format == InputFormat::Plain;
+    }
+}
+
+unique_ptr<istream> InputStream::Open(const string& filePath) {
+    InputFormat format = Detect(filePath);
+    if (format == InputFormat::Plain) {
+        auto file = make_unique<ifstream>(filePath);
+        if (!file->is_open()) return nullptr;
+        return file;
+    }
+    auto decoder = OpenDecoder(filePath, format, { 0, 0 }, nullptr);
+    if (!decoder) return nullptr;
+    return make_unique<DecodingStream>(move(decoder));
+}
+
+bool InputText::Load(const string& filePath) {
+    Release();
+    if (!ifstream(filePath, ios::binary).is_open()) return false;
+    format_ = InputStream::Detect(filePath);
+    if (!CodecAvailable(format_)) {
+        cerr << "ERROR: " << (format_ == InputFormat::Gzip ? "gzip" : "zstd")
+            << " input is not supported by this build" << endl;
+        return false;
+    }
+    path_ = filePath;
+    return true;
+}
+
+void InputText::Mark(const LineOffsets& offsets) {
+    for (const auto& offset : offsets) lines_[offset.first] = offset.second;
+}
+
+unique_ptr<istream> InputText::OpenAt(long line) const {
+    // Closest recorded line at or before the requested one
+    long markLine = 1;
+    uint64_t markOffset = 0;
+    auto mark = lines_.upper_bound(line);
+    if (mark != lines_.begin()) {
+        --mark;
+        markLine = mark->first;
+        markOffset = mark->second;
+    }
+
+    unique_ptr<istream> input;
+    if (format_ == InputFormat::Plain) {
+        auto file = make_unique<ifstream>(path_, ios::binary);
+        file->seekg(static_cast<streamoff>(markOffset));
+        input = move(file);
+    }
+    else {
+        // Closest recorded frame at or before the line
+        auto closest = [this](uint64_t offset) {
+            auto frame = upper_bound(frames_.begin(), frames_.end(), offset,
+                [](uint64_t value, const FrameOffset& f) { return value < f.decoded; });
+            return frame == frames_.begin() ? FrameOffset{ 0, 0 } : *--frame;
+        };
+        // The last decoder reads on when no stream uses it any more, it has
+        // not passed the line yet and no recorded frame starts closer
+        uint64_t position = 0;
+        if (decoder_ && decoder_.use_count() == 1) {
+            position = static_cast<uint64_t>(decoder_->pubseekoff(0, ios::cur, ios::in));
+            if (position > markOffset || closest(markOffset).decoded > position) decoder_.reset();
+        }
+        else {
+            decoder_.reset();
+        }
+        if (!decoder_) {
+            FrameOffset start = closest(markOffset);
+            // The first stream from the file start records where the frames begin
+            vector<FrameOffset>* record = nullptr;
+            if (!framesRecorded_ && start.compressed == 0) {
+                framesRecorded_ = true;
+                record = &frames_;
+            }
+            decoder_ = OpenDecoder(path_, format_, start, record);
+            position = start.decoded;
+        }
+        if (decoder_) input = make_unique<DecodingStream>(decoder_);
+        else input = make_unique<istringstream>();
+        // Decoded text before the line is read and dropped, not kept
+        input->ignore(static_cast<streamsize>(markOffset - position));
+    }
+    for (; markLine < line && *input; ++markLine) {
+        input->ignore(numeric_limits<streamsize>::max(), '\n');
+    }
+    return input;
+}
+
+void InputText::Release() {
+    decoder_.reset();
+    path_.clear();
+    format_ = InputFormat::Plain;
+    lines_.clear();
+    frames_.clear();
+    framesRecorded_ = false;
+}
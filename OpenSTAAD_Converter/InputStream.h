@@ -0,0 +1,56 @@
+#pragma once
+#include <cstdint>
+#include <istream>
+#include <map>
+#include <memory>
+#include <streambuf>
+#include <string>
+#include <utility>
+#include <vector>
+
+enum class InputFormat { Plain, Gzip, Zstd };
+
+namespace InputStream {
+    // Format from the file's magic bytes, not its extension.
+    InputFormat Detect(const std::string& filePath);
+
+    // Opens a .$2k export for line reading. gzip and zstd inputs are
+    // decompressed on the fly, with no temporary file; bgzip blocks and
+    // multi-frame zstd are decompressed in parallel ahead of the reader.
+    // Returns nullptr if the file cannot be opened or decoded.
+    std::unique_ptr<std::istream> Open(const std::string& filePath);
+}
+
+// 1-based line numbers with the decoded byte offset where each line starts
+typedef std::vector<std::pair<long, uint64_t>> LineOffsets;
+
+// One .$2k export read by line number without holding its text. Plain files
+// are reopened and seeked. Compressed files keep reading the last decoder
+// when the line is further on; otherwise they decode again from the closest
+// independent frame recorded by the first pass, or from the start when the
+// file is a single gzip member or zstd frame. Streams must not outlive it.
+class InputText {
+public:
+    // Checks the file can be opened and decoded; nothing is read yet.
+    bool Load(const std::string& filePath);
+    const std::string& Path() const { return path_; }
+    // Line starts found by the section scan, so OpenAt can seek to them
+    void Mark(const LineOffsets& offsets);
+    // Stream from the start of a 1-based line; empty past the last line.
+    std::unique_ptr<std::istream> OpenAt(long line) const;
+    void Release();
+
+    // Start of an independent compressed frame and of its decoded text
+    struct FrameOffset {
+        uint64_t compressed;
+        uint64_t decoded;
+    };
+
+private:
+    std::string path_;
+    InputFormat format_ = InputFormat::Plain;
+    std::map<long, uint64_t> lines_;
+    mutable std::vector<FrameOffset> frames_; // Filled while the first stream decodes
+    mutable bool framesRecorded_ = false;
+    mutable std::shared_ptr<std::streambuf> decoder_; // Compressed only, reused while reading on
+};
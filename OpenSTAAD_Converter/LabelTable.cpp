@@ -0,0 +1,111 @@
+#include "LabelTable.h"
+#include <algorithm>
+#include <charconv>
+
+using namespace std;
+
+namespace {
+    uint32_t Hash(string_view text) {
+        uint32_t hash = 2166136261u; // FNV-1a
+        for (unsigned char c : text) {
+            hash ^= c;
+            hash *= 16777619u;
+        }
+        return hash;
+    }
+
+    // Value of a canonical positive integer label, 0 for anything else.
+    // "007" is not canonical: it would share a number with "7".
+    int NumericValue(string_view text) {
+        if (text.empty() || text[0] < '1' || text[0] > '9') return 0;
+        int value = 0;
+        auto result = from_chars(text.data(), text.data() + text.size(), value);
+        return (result.ec == errc() && result.ptr == text.data() + text.size()) ? value : 0;
+    }
+}
+
+void LabelTable::Reserve(size_t labels, size_t poolBytes) {
+    pool_.reserve(poolBytes);
+    offsets_.reserve(labels + 1);
+    hashes_.reserve(labels);
+    numbers_.reserve(labels);
+    size_t capacity = 16;
+    while (capacity < 2 * labels) capacity *= 2;
+    if (capacity > slots_.size()) {
+        slots_.assign(capacity, kNone);
+        for (uint32_t index = 0; index < hashes_.size(); ++index) {
+            size_t mask = slots_.size() - 1;
+            size_t slot = hashes_[index] & mask;
+            while (slots_[slot] != kNone) slot = (slot + 1) & mask;
+            slots_[slot] = index;
+        }
+    }
+}
+
+void LabelTable::Grow() {
+    Reserve(max<size_t>(size() + 1, slots_.size()), pool_.size());
+}
+
+uint32_t LabelTable::Intern(string_view label) {
+    if (2 * (size() + 1) > slots_.size()) Grow();
+    const uint32_t hash = Hash(label);
+    const size_t mask = slots_.size() - 1;
+    size_t slot = hash & mask;
+    for (; slots_[slot] != kNone; slot = (slot + 1) & mask) {
+        uint32_t index = slots_[slot];
+        if (hashes_[index] == hash && Text(index) == label) return index;
+    }
+
+    uint32_t index = static_cast<uint32_t>(size());
+    slots_[slot] = index;
+    pool_.append(label.data(), label.size());
+    offsets_.push_back(static_cast<uint32_t>(pool_.size()));
+    hashes_.push_back(hash);
+    int number = NumericValue(label);
+    numbers_.push_back(number);
+    if (number == 0) alphanumeric_++;
+    else maxNumber_ = max(maxNumber_, number);
+    return index;
+}
+
+uint32_t LabelTable::Find(string_view label) const {
+    if (slots_.empty()) return kNone;
+    const uint32_t hash = Hash(label);
+    const size_t mask = slots_.size() - 1;
+    for (size_t slot = hash & mask; slots_[slot] != kNone; slot = (slot + 1) & mask) {
+        uint32_t index = slots_[slot];
+        if (hashes_[index] == hash && Text(index) == label) return index;
+    }
+    return kNone;
+}
+
+string_view LabelTable::Text(uint32_t index) const {
+    return string_view(pool_.data() + offsets_[index], offsets_[index + 1] - offsets_[index]);
+}
+
+void LabelTable::NumberLabels(const LabelTable* taken) {
+    vector<int> takenNumbers;
+    if (taken) {
+        takenNumbers = taken->numbers_;
+        sort(takenNumbers.begin(), takenNumbers.end());
+        maxNumber_ = max(maxNumber_, taken->maxNumber_);
+    }
+    for (int& number : numbers_) {
+        if (number != 0 && binary_search(takenNumbers.begin(), takenNumbers.end(), number)) {
+            number = 0;
+            renumbered_++;
+        }
+        if (number == 0) number = ++maxNumber_;
+    }
+}
+
+void LabelTable::Clear() {
+    string().swap(pool_);
+    vector<uint32_t>{ 0 }.swap(offsets_);
+    vector<uint32_t>().swap(hashes_);
+    vector<int>().swap(numbers_);
+    vector<uint32_t>().swap(slots_);
+    alphanumeric_ = 0;
+    renumbered_ = 0;
+    maxNumber_ = 0;
+}
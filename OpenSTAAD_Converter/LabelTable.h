@@ -0,0 +1,47 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+// Interned SAP2000 object labels ("12", "A12", "B3-1"). Each distinct label
+// gets a dense index in first-seen order and its text is kept in one
+// contiguous pool, so the model stores and compares plain integers while the
+// reports can still print what the user typed in SAP2000.
+//
+// Every label also has a STAAD number: a plain positive integer label keeps
+// its value, the rest are numbered by NumberLabels after the largest numeric
+// label, in first-seen order. Call it once every table has been read.
+//
+// Frames and cables have a table each but share the STAAD member numbering:
+// numbering the cables with the frame table as `taken` also moves a cable
+// whose number a frame already has after the largest number of both.
+class LabelTable {
+public:
+    static constexpr uint32_t kNone = UINT32_MAX;
+
+    void Reserve(size_t labels, size_t poolBytes);
+    uint32_t Intern(std::string_view label);
+    uint32_t Find(std::string_view label) const;
+    std::string_view Text(uint32_t index) const;
+    int Number(uint32_t index) const { return numbers_[index]; }
+    void NumberLabels(const LabelTable* taken = nullptr);
+    size_t size() const { return numbers_.size(); }
+    size_t AlphanumericCount() const { return alphanumeric_; }
+    size_t RenumberedCount() const { return renumbered_; } // Numeric labels moved off a taken number
+    size_t PoolBytes() const { return pool_.size(); }
+    void Clear();
+
+private:
+    void Grow();
+
+    std::string pool_;
+    std::vector<uint32_t> offsets_{ 0 }; // size() + 1 entries into pool_
+    std::vector<uint32_t> hashes_;
+    std::vector<int> numbers_;           // 0 until NumberLabels for the alphanumeric ones
+    std::vector<uint32_t> slots_;        // Open addressing, kNone = empty
+    size_t alphanumeric_ = 0;
+    size_t renumbered_ = 0;
+    int maxNumber_ = 0;
+};
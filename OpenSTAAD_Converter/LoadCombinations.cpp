@@ -0,0 +1,206 @@
+#include "LoadCombinations.h"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <numeric>
+#include <unordered_map>
+
+using namespace std;
+
+namespace {
+    enum : uint8_t { kUnvisited, kActive, kDone, kInvalid };
+
+    // Factors this small are left over from cancelling terms
+    const double kZeroFactor = 1e-12;
+
+    uint64_t HashRow(const uint32_t* patterns, const double* factors, size_t count) {
+        uint64_t hash = 1469598103934665603ull; // FNV-1a
+        for (size_t e = 0; e < count; ++e) {
+            uint64_t bits;
+            memcpy(&bits, &factors[e], sizeof(bits));
+            hash = (hash ^ patterns[e]) * 1099511628211ull;
+            hash = (hash ^ bits) * 1099511628211ull;
+        }
+        return hash;
+    }
+}
+
+void CombinationReport::PrintSummary(ostream& out) const {
+    out << "  " << defined << " combinations: " << emitted << " to create, "
+        << duplicates << " duplicate, " << empty << " empty, "
+        << unsupported << " unsupported, " << cycles << " cyclic ("
+        << milliseconds << " ms)\n";
+}
+
+CombinationMatrix LoadCombinations::Flatten(const SAP2000Model& model, CombinationReport& report) {
+    auto start = chrono::steady_clock::now();
+    const auto& terms = model.comboTerms;
+    const size_t comboCount = model.comboNames.size();
+    report.defined = comboCount;
+
+    // Terms grouped by combination, counting sort into CSR
+    vector<uint32_t> termOffsets(comboCount + 1, 0);
+    for (const auto& term : terms) termOffsets[term.combo + 1]++;
+    partial_sum(termOffsets.begin(), termOffsets.end(), termOffsets.begin());
+    vector<uint32_t> termOrder(terms.size());
+    vector<uint32_t> fill(termOffsets.begin(), termOffsets.end() - 1);
+    for (uint32_t t = 0; t < terms.size(); ++t) termOrder[fill[terms[t].combo]++] = t;
+
+    // Flattened combinations in completion order, CSR addressed by memoBegin/End
+    vector<uint8_t> state(comboCount, kUnvisited);
+    vector<uint8_t> cyclic(comboCount, 0);
+    vector<uint32_t> memoBegin(comboCount, 0), memoEnd(comboCount, 0);
+    vector<uint32_t> memoPatterns;
+    vector<double> memoFactors;
+
+    // Dense accumulator with a touched list, so clearing costs only what was used
+    vector<double> accumulator(model.patternNames.size(), 0.0);
+    vector<uint8_t> touched(model.patternNames.size(), 0);
+    vector<uint32_t> touchedList;
+    auto add = [&](uint32_t pattern, double factor) {
+        if (!touched[pattern]) {
+            touched[pattern] = 1;
+            touchedList.push_back(pattern);
+        }
+        accumulator[pattern] += factor;
+    };
+
+    // Iterative post-order DFS: nested combinations finish before their parents,
+    // however deep the nesting goes. The active combinations form the current
+    // path, so a nested one still active closes a cycle through all of them.
+    vector<uint32_t> stack;
+    vector<uint32_t> path;
+    vector<uint32_t> pathIndex(comboCount, 0);
+    for (uint32_t root = 0; root < comboCount; ++root) {
+        if (state[root] != kUnvisited) continue;
+        stack.push_back(root);
+        while (!stack.empty()) {
+            uint32_t c = stack.back();
+            if (state[c] == kUnvisited) {
+                state[c] = kActive;
+                pathIndex[c] = static_cast<uint32_t>(path.size());
+                path.push_back(c);
+                for (uint32_t e = termOffsets[c]; e < termOffsets[c + 1]; ++e) {
+                    const ComboTerm& term = terms[termOrder[e]];
+                    if (term.kind != ComboTerm::Combo) continue;
+                    if (state[term.target] == kUnvisited) {
+                        stack.push_back(term.target);
+                    } else if (state[term.target] == kActive) {
+                        for (size_t p = pathIndex[term.target]; p < path.size(); ++p) cyclic[path[p]] = 1;
+                    }
+                }
+                continue;
+            }
+            stack.pop_back();
+            if (state[c] != kActive) continue; // Pushed by two parents, already finished
+            path.pop_back();
+
+            bool valid = !cyclic[c] && model.comboKinds[c] == ComboKind::LinearAdd;
+            for (uint32_t e = termOffsets[c]; valid && e < termOffsets[c + 1]; ++e) {
+                const ComboTerm& term = terms[termOrder[e]];
+                valid = term.kind == ComboTerm::Pattern ||
+                    (term.kind == ComboTerm::Combo && state[term.target] == kDone);
+            }
+            if (!valid) {
+                state[c] = kInvalid;
+                if (cyclic[c]) report.cycles++;
+                else report.unsupported++;
+                continue;
+            }
+
+            for (uint32_t e = termOffsets[c]; e < termOffsets[c + 1]; ++e) {
+                const ComboTerm& term = terms[termOrder[e]];
+                if (term.kind == ComboTerm::Pattern) {
+                    add(term.target, term.factor);
+                    continue;
+                }
+                for (uint32_t m = memoBegin[term.target]; m < memoEnd[term.target]; ++m) {
+                    add(memoPatterns[m], term.factor * memoFactors[m]);
+                }
+            }
+            sort(touchedList.begin(), touchedList.end());
+            memoBegin[c] = static_cast<uint32_t>(memoPatterns.size());
+            for (uint32_t pattern : touchedList) {
+                if (fabs(accumulator[pattern]) > kZeroFactor) {
+                    memoPatterns.push_back(pattern);
+                    memoFactors.push_back(accumulator[pattern] + 0.0); // No -0
+                }
+                accumulator[pattern] = 0.0;
+                touched[pattern] = 0;
+            }
+            touchedList.clear();
+            memoEnd[c] = static_cast<uint32_t>(memoPatterns.size());
+            state[c] = kDone;
+        }
+    }
+
+    // Emit in file order, keeping the first of identical rows
+    CombinationMatrix matrix;
+    matrix.rowOf.assign(comboCount, CombinationMatrix::kNoRow);
+    unordered_map<uint64_t, vector<uint32_t>> rowsByHash;
+    for (uint32_t c = 0; c < comboCount; ++c) {
+        if (state[c] != kDone) continue;
+        size_t count = memoEnd[c] - memoBegin[c];
+        if (count == 0) {
+            report.empty++;
+            continue;
+        }
+        const uint32_t* patterns = memoPatterns.data() + memoBegin[c];
+        const double* factors = memoFactors.data() + memoBegin[c];
+        auto& candidates = rowsByHash[HashRow(patterns, factors, count)];
+        bool duplicate = false;
+        for (uint32_t row : candidates) {
+            uint32_t begin = matrix.offsets[row];
+            duplicate = matrix.offsets[row + 1] - begin == count &&
+                equal(patterns, patterns + count, matrix.patterns.begin() + begin) &&
+                equal(factors, factors + count, matrix.factors.begin() + begin);
+            if (duplicate) {
+                matrix.rowOf[c] = row;
+                break;
+            }
+        }
+        if (duplicate) {
+            report.duplicates++;
+            continue;
+        }
+        matrix.rowOf[c] = static_cast<uint32_t>(matrix.Rows());
+        candidates.push_back(static_cast<uint32_t>(matrix.Rows()));
+        matrix.patterns.insert(matrix.patterns.end(), patterns, patterns + count);
+        matrix.factors.insert(matrix.factors.end(), factors, factors + count);
+        matrix.offsets.push_back(static_cast<uint32_t>(matrix.patterns.size()));
+        matrix.combos.push_back(c);
+    }
+    report.emitted = matrix.Rows();
+    report.milliseconds = chrono::duration<double, milli>(chrono::steady_clock::now() - start).count();
+    return matrix;
+}
+
+long LoadCombinations::FirstLoadNumber(size_t patternCount) {
+    return static_cast<long>(patternCount / 100 + 1) * 100 + 1;
+}
+
+bool LoadCombinations::WriteMap(const SAP2000Model& model, const CombinationMatrix& matrix, const string& mapPath) {
+    ofstream map(mapPath);
+    if (!map.is_open()) {
+        cerr << "ERROR: Failed to write combination map: " << mapPath << endl;
+        return false;
+    }
+    const long firstNumber = FirstLoadNumber(model.patternNames.size());
+    map << "sap,staad,note\n";
+    for (uint32_t c = 0; c < matrix.rowOf.size(); ++c) {
+        uint32_t row = matrix.rowOf[c];
+        map << model.comboNames[c] << ",";
+        if (row == CombinationMatrix::kNoRow) {
+            map << ",not created\n";
+            continue;
+        }
+        map << firstNumber + row;
+        if (matrix.combos[row] != c) map << ",same as " << model.comboNames[matrix.combos[row]];
+        else map << ",";
+        map << "\n";
+    }
+    return true;
+}
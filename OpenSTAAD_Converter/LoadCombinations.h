@@ -0,0 +1,45 @@
+#pragma once
+#include <cstdint>
+#include <iosfwd>
+#include <string>
+#include <vector>
+#include "SAP2000Model.h"
+
+// Flattened combinations as a sparse matrix in compressed sparse rows: row r
+// is combination combos[r] with its factors on the primary load patterns.
+struct CombinationMatrix {
+    std::vector<uint32_t> offsets{ 0 }; // Rows() + 1 entries
+    std::vector<uint32_t> patterns;     // Index into patternNames, ascending per row
+    std::vector<double> factors;
+    std::vector<uint32_t> combos;       // Index into comboNames
+    std::vector<uint32_t> rowOf;        // Per comboNames: its row, or the row of an equal one; kNoRow if not created
+    size_t Rows() const { return combos.size(); }
+    static constexpr uint32_t kNoRow = UINT32_MAX;
+};
+
+struct CombinationReport {
+    size_t defined = 0;     // Combinations in the file
+    size_t emitted = 0;     // Distinct rows left to create
+    size_t duplicates = 0;  // Same factors as an earlier combination
+    size_t empty = 0;       // Every factor cancelled out
+    size_t unsupported = 0; // Not Linear Add, or using an unsupported case or combination
+    size_t cycles = 0;      // Combinations that end up nesting themselves
+    double milliseconds = 0.0;
+
+    void PrintSummary(std::ostream& out) const;
+};
+
+namespace LoadCombinations {
+    // Expands nested Linear Add combinations into pattern factors, flattening
+    // each combination once and reusing it wherever it is nested, then drops
+    // rows equal to an earlier one.
+    CombinationMatrix Flatten(const SAP2000Model& model, CombinationReport& report);
+
+    // STAAD load number of row 0; primary loads take 1..patternCount and the
+    // combinations start at the next hundred.
+    long FirstLoadNumber(size_t patternCount);
+
+    // SAP combination -> STAAD load number, one "sap,staad,note" line each,
+    // so duplicates and combinations that were not created can be traced.
+    bool WriteMap(const SAP2000Model& model, const CombinationMatrix& matrix, const std::string& mapPath);
+}
@@ -0,0 +1,298 @@
+#include "LocalChannel.h"
+#include <cerrno>
+#include <cstring>
+#include <iostream>
+#ifdef _WIN32
+#define NOMINMAX
+#include <windows.h>
+#else
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+#include <unistd.h>
+#endif
+
+using namespace std;
+
+namespace {
+    const intptr_t kInvalid = -1;
+
+#ifdef _WIN32
+    HANDLE AsHandle(intptr_t handle) { return reinterpret_cast<HANDLE>(handle); }
+    intptr_t FromHandle(HANDLE handle) { return reinterpret_cast<intptr_t>(handle); }
+
+    // Overlapped I/O waited on at once, so a read pending on one thread does
+    // not hold up a write from another on the same pipe
+    bool Transfer(HANDLE pipe, bool read, void* buffer, DWORD size, DWORD& transferred) {
+        OVERLAPPED overlapped = {};
+        overlapped.hEvent = CreateEventW(NULL, TRUE, FALSE, NULL);
+        if (!overlapped.hEvent) return false;
+        BOOL started = read
+            ? ReadFile(pipe, buffer, size, NULL, &overlapped)
+            : WriteFile(pipe, buffer, size, NULL, &overlapped);
+        bool done = (started || GetLastError() == ERROR_IO_PENDING) &&
+            GetOverlappedResult(pipe, &overlapped, &transferred, TRUE);
+        CloseHandle(overlapped.hEvent);
+        return done;
+    }
+
+    HANDLE CreatePipeInstance(const string& address, bool first) {
+        DWORD openMode = PIPE_ACCESS_DUPLEX | FILE_FLAG_OVERLAPPED |
+            (first ? FILE_FLAG_FIRST_PIPE_INSTANCE : 0);
+        return CreateNamedPipeA(address.c_str(), openMode,
+            PIPE_TYPE_BYTE | PIPE_READMODE_BYTE | PIPE_WAIT | PIPE_REJECT_REMOTE_CLIENTS,
+            PIPE_UNLIMITED_INSTANCES, 64 * 1024, 64 * 1024, 0, NULL);
+    }
+#else
+    // Connected socket descriptor, or -1 with errno set
+    int ConnectSocket(const string& address) {
+        sockaddr_un addr = {};
+        addr.sun_family = AF_UNIX;
+        if (address.size() >= sizeof(addr.sun_path)) {
+            errno = ENAMETOOLONG;
+            return -1;
+        }
+        memcpy(addr.sun_path, address.c_str(), address.size() + 1);
+        int fd = socket(AF_UNIX, SOCK_STREAM, 0);
+        if (fd < 0) return -1;
+        if (connect(fd, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) != 0) {
+            int error = errno;
+            close(fd);
+            errno = error;
+            return -1;
+        }
+        return fd;
+    }
+#endif
+}
+
+LocalConnection::LocalConnection(intptr_t handle) : handle_(handle) {}
+
+LocalConnection::~LocalConnection() {
+    if (handle_ == kInvalid) return;
+#ifdef _WIN32
+    // Let the other end drain what was written before the pipe goes away
+    if (!closed_) FlushFileBuffers(AsHandle(handle_));
+    CloseHandle(AsHandle(handle_));
+#else
+    close(static_cast<int>(handle_));
+#endif
+}
+
+void LocalConnection::Close() {
+    closed_ = true;
+#ifdef _WIN32
+    CancelIoEx(AsHandle(handle_), NULL);
+#else
+    shutdown(static_cast<int>(handle_), SHUT_RDWR);
+#endif
+}
+
+bool LocalConnection::Read(char* buffer, size_t size, size_t& received) {
+#ifdef _WIN32
+    DWORD count = 0;
+    if (!Transfer(AsHandle(handle_), true, buffer, static_cast<DWORD>(size), count)) return false;
+    received = count;
+    return true;
+#else
+    for (;;) {
+        ssize_t count = recv(static_cast<int>(handle_), buffer, size, 0);
+        if (count < 0 && errno == EINTR) continue;
+        if (count < 0) return false;
+        received = static_cast<size_t>(count);
+        return true;
+    }
+#endif
+}
+
+bool LocalConnection::Write(const char* data, size_t size) {
+    while (size > 0) {
+#ifdef _WIN32
+        DWORD count = 0;
+        if (!Transfer(AsHandle(handle_), false, const_cast<char*>(data), static_cast<DWORD>(size), count)) return false;
+#else
+#ifdef MSG_NOSIGNAL
+        ssize_t count = send(static_cast<int>(handle_), data, size, MSG_NOSIGNAL);
+#else
+        ssize_t count = send(static_cast<int>(handle_), data, size, 0);
+#endif
+        if (count < 0 && errno == EINTR) continue;
+        if (count <= 0) return false;
+#endif
+        data += count;
+        size -= static_cast<size_t>(count);
+    }
+    return true;
+}
+
+bool LocalConnection::ReadLine(string& line) {
+    for (;;) {
+        size_t newline = pending_.find('\n');
+        if (newline != string::npos) {
+            line.assign(pending_, 0, newline);
+            if (!line.empty() && line.back() == '\r') line.pop_back();
+            pending_.erase(0, newline + 1);
+            return true;
+        }
+        char buffer[4096];
+        size_t received = 0;
+        if (!Read(buffer, sizeof(buffer), received) || received == 0) {
+            if (pending_.empty()) return false;
+            line.swap(pending_);
+            pending_.clear();
+            return true;
+        }
+        pending_.append(buffer, received);
+    }
+}
+
+bool LocalConnection::WriteLine(const string& line) {
+    lock_guard<mutex> lock(writeMutex_);
+    string data = line;
+    data += '\n';
+    return Write(data.data(), data.size());
+}
+
+string LocalChannel::Address(const string& endpoint) {
+#ifdef _WIN32
+    if (endpoint.rfind(R"(\\.\pipe\)", 0) == 0) return endpoint;
+    return R"(\\.\pipe\)" + endpoint;
+#else
+    if (endpoint.find('/') != string::npos) return endpoint;
+    return "/tmp/" + endpoint + ".sock";
+#endif
+}
+
+unique_ptr<LocalConnection> LocalChannel::Connect(const string& endpoint) {
+    string address = Address(endpoint);
+#ifdef _WIN32
+    for (int attempt = 0; attempt < 10; ++attempt) {
+        HANDLE pipe = CreateFileA(address.c_str(), GENERIC_READ | GENERIC_WRITE, 0, NULL,
+            OPEN_EXISTING, FILE_FLAG_OVERLAPPED, NULL);
+        if (pipe != INVALID_HANDLE_VALUE) return make_unique<LocalConnection>(FromHandle(pipe));
+        if (GetLastError() != ERROR_PIPE_BUSY || !WaitNamedPipeA(address.c_str(), 5000)) break;
+    }
+    cerr << "ERROR: Could not connect to " << address << " (error " << GetLastError() << ")" << endl;
+    return nullptr;
+#else
+    int fd = ConnectSocket(address);
+    if (fd < 0) {
+        cerr << "ERROR: Could not connect to " << address << ": " << strerror(errno) << endl;
+        return nullptr;
+    }
+    return make_unique<LocalConnection>(fd);
+#endif
+}
+
+LocalListener::LocalListener() : handle_(kInvalid), nextPipe_(kInvalid) {}
+
+LocalListener::~LocalListener() {
+    Close();
+#ifdef _WIN32
+    if (nextPipe_ != kInvalid) CloseHandle(AsHandle(nextPipe_));
+    if (handle_ != kInvalid) CloseHandle(AsHandle(handle_));
+#else
+    if (handle_ != kInvalid) close(static_cast<int>(handle_));
+#endif
+}
+
+bool LocalListener::Listen(const string& endpoint) {
+    address_ = LocalChannel::Address(endpoint);
+#ifdef _WIN32
+    // The first instance fails if another service already owns the name
+    HANDLE pipe = CreatePipeInstance(address_, true);
+    if (pipe == INVALID_HANDLE_VALUE) {
+        cerr << "ERROR: Could not create pipe " << address_ << " (error " << GetLastError()
+            << "), is another service running?" << endl;
+        return false;
+    }
+    nextPipe_ = FromHandle(pipe);
+    handle_ = FromHandle(CreateEventW(NULL, TRUE, FALSE, NULL));
+    return handle_ != 0;
+#else
+    sockaddr_un addr = {};
+    addr.sun_family = AF_UNIX;
+    if (address_.size() >= sizeof(addr.sun_path)) {
+        cerr << "ERROR: Socket path too long: " << address_ << endl;
+        return false;
+    }
+    memcpy(addr.sun_path, address_.c_str(), address_.size() + 1);
+
+    // A socket file nobody answers on was left by a service that crashed
+    int running = ConnectSocket(address_);
+    if (running >= 0) {
+        close(running);
+        cerr << "ERROR: Another service is listening on " << address_ << endl;
+        return false;
+    }
+    unlink(address_.c_str());
+
+    int fd = socket(AF_UNIX, SOCK_STREAM, 0);
+    if (fd < 0) {
+        cerr << "ERROR: Could not create socket: " << strerror(errno) << endl;
+        return false;
+    }
+    // Owner only from the moment the socket file exists, like a named
+    // pipe's default security
+    mode_t previousMask = umask(S_IRWXG | S_IRWXO);
+    bool bound = bind(fd, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) == 0;
+    umask(previousMask);
+    if (!bound || listen(fd, 16) != 0) {
+        cerr << "ERROR: Could not listen on " << address_ << ": " << strerror(errno) << endl;
+        close(fd);
+        return false;
+    }
+    handle_ = fd;
+    return true;
+#endif
+}
+
+unique_ptr<LocalConnection> LocalListener::Accept() {
+    if (closed_ || handle_ == kInvalid) return nullptr;
+#ifdef _WIN32
+    HANDLE pipe = nextPipe_ != kInvalid ? AsHandle(nextPipe_) : CreatePipeInstance(address_, false);
+    nextPipe_ = kInvalid;
+    if (pipe == INVALID_HANDLE_VALUE) return nullptr;
+
+    OVERLAPPED overlapped = {};
+    overlapped.hEvent = CreateEventW(NULL, TRUE, FALSE, NULL);
+    bool connected = ConnectNamedPipe(pipe, &overlapped) != 0 || GetLastError() == ERROR_PIPE_CONNECTED;
+    if (!connected && GetLastError() == ERROR_IO_PENDING) {
+        HANDLE events[2] = { overlapped.hEvent, AsHandle(handle_) };
+        DWORD signaled = WaitForMultipleObjects(2, events, FALSE, INFINITE);
+        DWORD unused = 0;
+        if (signaled == WAIT_OBJECT_0) {
+            connected = GetOverlappedResult(pipe, &overlapped, &unused, FALSE) != 0;
+        }
+        else {
+            CancelIoEx(pipe, &overlapped);
+            GetOverlappedResult(pipe, &overlapped, &unused, TRUE);
+        }
+    }
+    CloseHandle(overlapped.hEvent);
+    if (!connected) {
+        CloseHandle(pipe);
+        return nullptr;
+    }
+    return make_unique<LocalConnection>(FromHandle(pipe));
+#else
+    for (;;) {
+        int fd = accept(static_cast<int>(handle_), nullptr, nullptr);
+        if (fd >= 0) return make_unique<LocalConnection>(fd);
+        if (errno != EINTR || closed_) return nullptr;
+    }
+#endif
+}
+
+void LocalListener::Close() {
+    if (closed_) return;
+    closed_ = true;
+    if (handle_ == kInvalid) return;
+#ifdef _WIN32
+    SetEvent(AsHandle(handle_));
+#else
+    // Wakes a thread blocked in accept; the descriptor is closed with the listener
+    shutdown(static_cast<int>(handle_), SHUT_RDWR);
+    unlink(address_.c_str());
+#endif
+}
@@ -0,0 +1,55 @@
+#pragma once
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+
+// Line-oriented connection on this machine only: a Unix domain socket, or a
+// named pipe (\\.\pipe\<name>) on Windows. Reads and writes may run on
+// different threads at the same time; writes are serialized.
+class LocalConnection {
+public:
+    explicit LocalConnection(intptr_t handle);
+    ~LocalConnection();
+    LocalConnection(const LocalConnection&) = delete;
+    LocalConnection& operator=(const LocalConnection&) = delete;
+
+    // Next line without the newline; false at end of stream
+    bool ReadLine(std::string& line);
+    bool WriteLine(const std::string& line);
+    // Unblocks a pending ReadLine on another thread
+    void Close();
+private:
+    bool Read(char* buffer, size_t size, size_t& received);
+    bool Write(const char* data, size_t size);
+
+    intptr_t handle_;
+    std::string pending_;
+    std::mutex writeMutex_;
+    std::atomic<bool> closed_{ false };
+};
+
+class LocalListener {
+public:
+    LocalListener();
+    ~LocalListener();
+    LocalListener(const LocalListener&) = delete;
+    LocalListener& operator=(const LocalListener&) = delete;
+
+    bool Listen(const std::string& endpoint);
+    // Blocks for the next client; nullptr once Close was called
+    std::unique_ptr<LocalConnection> Accept();
+    void Close();
+private:
+    std::string address_;
+    intptr_t handle_;     // Listening socket, or the stop event on Windows
+    intptr_t nextPipe_;   // Windows: pipe instance waiting for the next client
+    std::atomic<bool> closed_{ false };
+};
+
+namespace LocalChannel {
+    // Socket path or pipe name for an endpoint name such as "sap2staad"
+    std::string Address(const std::string& endpoint);
+    std::unique_ptr<LocalConnection> Connect(const std::string& endpoint);
+}
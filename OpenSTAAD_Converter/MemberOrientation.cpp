@@ -0,0 +1,123 @@
+#include "MemberOrientation.h"
+#include "Parallel.h"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <iostream>
+#include <set>
+#include <utility>
+#include <vector>
+
+using namespace std;
+
+namespace {
+    const uint32_t kNone = UINT32_MAX;
+
+    // SAP2000 treats a frame as vertical when the sine of its angle to the up
+    // axis is below 1e-3; the same test decides STAAD's vertical rule here.
+    const double kVerticalSine = 1e-3;
+}
+
+// Both programs put local 2 / local y in the plane of the member and the up
+// axis, pointing up, so non-vertical members keep the SAP angle as beta.
+// Vertical members differ: SAP points local 2 along +X, STAAD keeps local z
+// along the horizontal axis that maps to -Y in SAP, i.e. local y = -X for a
+// member pointing up and +X for one pointing down. Upward members therefore
+// need an extra 180 degrees.
+void MemberOrientation::ComputeBetas(const double* dx, const double* dy, const double* dz,
+    const double* sapAngle, double* beta, size_t count) {
+    const double tol2 = kVerticalSine * kVerticalSine;
+    for (size_t i = 0; i < count; ++i) {
+        // Horizontal part squared against the full length squared: no
+        // cancellation for near-vertical members, no sqrt or division
+        double horizontal2 = dx[i] * dx[i] + dy[i] * dy[i];
+        double length2 = horizontal2 + dz[i] * dz[i];
+        bool upward = horizontal2 < tol2 * length2 && dz[i] > 0.0;
+        double angle = sapAngle[i] + (upward ? 180.0 : 0.0);
+        beta[i] = angle - 360.0 * floor((angle + 180.0) / 360.0); // [-180, 180)
+    }
+}
+
+OrientationReport MemberOrientation::Apply(SAP2000Model& model, bool parallel) {
+    OrientationReport report;
+    auto start = chrono::steady_clock::now();
+
+    const vector<uint32_t> nodeByLabel = model.NodeByLabel();
+    auto lookup = [&](uint32_t label) { return nodeByLabel[label]; };
+    auto angleOf = [&](uint32_t frameId) -> const FrameLocalAxis* {
+        auto it = lower_bound(model.localAxes.begin(), model.localAxes.end(), frameId,
+            [](const FrameLocalAxis& a, uint32_t id) { return a.frameId < id; });
+        return (it != model.localAxes.end() && it->frameId == frameId) ? &*it : nullptr;
+    };
+
+    // Gather member directions into SAP axes, structure-of-arrays. The Y-up
+    // remap (x, z, -y) is undone so one kernel serves both axis conventions.
+    const size_t count = model.beams.size();
+    vector<double> dx(count), dy(count), dz(count), angle(count), beta(count);
+    const double* x = model.coordinates.x.data();
+    const double* y = model.coordinates.y.data();
+    const double* z = model.coordinates.z.data();
+    const bool yUp = model.upAxis == UpAxis::Y;
+
+    Parallel::For(count, [&](size_t begin, size_t end) {
+        for (size_t k = begin; k < end; ++k) {
+            const Beam& beam = model.beams[k];
+            const FrameLocalAxis* axis = angleOf(beam.sapId);
+            angle[k] = axis ? axis->angle : 0.0;
+            uint32_t i = lookup(beam.startNodeId);
+            uint32_t j = lookup(beam.endNodeId);
+            if (i == kNone || j == kNone) {
+                dx[k] = dy[k] = dz[k] = 0.0; // Left to the validator
+                continue;
+            }
+            dx[k] = x[j] - x[i];
+            dy[k] = yUp ? -(z[j] - z[i]) : y[j] - y[i];
+            dz[k] = yUp ? y[j] - y[i] : z[j] - z[i];
+        }
+    }, parallel);
+
+    Parallel::For(count, [&](size_t begin, size_t end) {
+        ComputeBetas(dx.data() + begin, dy.data() + begin, dz.data() + begin,
+            angle.data() + begin, beta.data() + begin, end - begin);
+    }, parallel);
+
+    set<double> distinct;
+    const double tol2 = kVerticalSine * kVerticalSine;
+    for (size_t k = 0; k < count; ++k) {
+        model.beams[k].beta = beta[k];
+        double horizontal2 = dx[k] * dx[k] + dy[k] * dy[k];
+        if (horizontal2 < tol2 * (horizontal2 + dz[k] * dz[k])) report.vertical++;
+        if (beta[k] != 0.0) {
+            report.rotated++;
+            distinct.insert(beta[k]);
+        }
+    }
+    report.betaGroups = distinct.size();
+
+    for (const auto& axis : model.localAxes) {
+        if (axis.advanced) report.advancedAxes++;
+    }
+    for (const auto& insertion : model.insertions) {
+        bool hasOffset = false;
+        for (int c = 0; c < 3; ++c) {
+            hasOffset = hasOffset || insertion.offsetI[c] != 0.0 || insertion.offsetJ[c] != 0.0;
+        }
+        if (hasOffset) report.offsets++;
+        if (insertion.cardinalPoint != 10) report.cardinalPoints++;
+    }
+
+    report.milliseconds = chrono::duration<double, milli>(chrono::steady_clock::now() - start).count();
+    cout << "Member orientation: " << report.rotated << " rotated member(s) in " << report.betaGroups
+        << " beta group(s), " << report.vertical << " vertical, " << report.offsets
+        << " with insertion offsets (" << report.milliseconds << " ms)" << endl;
+    if (report.advancedAxes > 0) {
+        cerr << "Warning: " << report.advancedAxes
+            << " frame(s) use advanced local axes; only their typical angle was converted" << endl;
+    }
+    if (report.cardinalPoints > 0) {
+        cerr << "Warning: " << report.cardinalPoints
+            << " frame(s) use a cardinal point other than the centroid; not converted" << endl;
+    }
+    return report;
+}
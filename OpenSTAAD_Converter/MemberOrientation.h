@@ -0,0 +1,25 @@
+#pragma once
+#include <cstddef>
+#include "SAP2000Model.h"
+
+struct OrientationReport {
+    size_t rotated = 0;        // Members with a nonzero beta
+    size_t vertical = 0;       // Members along the up axis
+    size_t advancedAxes = 0;   // Advanced local axes, converted from the typical angle only
+    size_t offsets = 0;        // Members with insertion offsets
+    size_t cardinalPoints = 0; // Cardinal points other than the centroid, not converted
+    size_t betaGroups = 0;     // Distinct nonzero beta angles
+    double milliseconds = 0.0;
+};
+
+namespace MemberOrientation {
+    // STAAD beta (degrees) for members along (dx, dy, dz) in SAP2000 axes
+    // (Z up), given the SAP local axis angle. Plain loops over the arrays so
+    // the compiler can vectorize them.
+    void ComputeBetas(const double* dx, const double* dy, const double* dz,
+        const double* sapAngle, double* beta, size_t count);
+
+    // Fills Beam::beta from the local axes table and the member directions.
+    // Runs on the coordinate arrays in whatever axes the model is in.
+    OrientationReport Apply(SAP2000Model& model, bool parallel = true);
+}
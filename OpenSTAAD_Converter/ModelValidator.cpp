@@ -0,0 +1,343 @@
+#include "ModelValidator.h"
+#include "Parallel.h"
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <fstream>
+#include <iostream>
+#include <numeric>
+
+using namespace std;
+
+namespace {
+    const uint32_t kNone = UINT32_MAX;
+
+    // Member issue flags
+    const uint8_t kMissingJoint = 1;
+    const uint8_t kZeroLength = 2;
+    const uint8_t kDuplicateId = 4;
+    const uint8_t kDuplicateMember = 8;
+    const uint8_t kNumberClash = 16; // Frame and cable with the same STAAD number
+
+    const char* IssueText(IssueKind kind) {
+        switch (kind) {
+        case IssueKind::DuplicateJoint: return "duplicate joint ID";
+        case IssueKind::MissingJoint: return "references missing joint";
+        case IssueKind::DuplicateMemberId: return "duplicate member ID";
+        case IssueKind::ZeroLength: return "zero-length member";
+        case IssueKind::DuplicateMember: return "same joints as member";
+        case IssueKind::UnknownSupportJoint: return "support on missing joint";
+        default: return "unknown";
+        }
+    }
+
+    // Lock-free union-find: roots are only ever linked by CAS, larger index
+    // under smaller, and Find compresses paths by halving. Safe to call
+    // Unite from several threads at once.
+    class ConcurrentUnionFind {
+    public:
+        explicit ConcurrentUnionFind(size_t count) : parent_(count) {
+            for (size_t i = 0; i < count; ++i) {
+                parent_[i].store(static_cast<uint32_t>(i), memory_order_relaxed);
+            }
+        }
+
+        uint32_t Find(uint32_t x) {
+            for (;;) {
+                uint32_t p = parent_[x].load(memory_order_relaxed);
+                if (p == x) return x;
+                uint32_t gp = parent_[p].load(memory_order_relaxed);
+                if (gp != p) parent_[x].compare_exchange_weak(p, gp, memory_order_relaxed);
+                x = gp;
+            }
+        }
+
+        void Unite(uint32_t a, uint32_t b) {
+            for (;;) {
+                a = Find(a);
+                b = Find(b);
+                if (a == b) return;
+                if (a < b) swap(a, b);
+                uint32_t expected = a;
+                if (parent_[a].compare_exchange_strong(expected, b, memory_order_relaxed)) return;
+            }
+        }
+
+    private:
+        vector<atomic<uint32_t>> parent_;
+    };
+
+    // Beams and cables share the STAAD member numbering, so they are checked
+    // as one list: beams first, then cables.
+    struct MemberView {
+        SAP2000Model& model;
+        size_t size() const { return model.beams.size() + model.cables.size(); }
+        bool IsCable(size_t k) const { return k >= model.beams.size(); }
+        uint32_t Id(size_t k) const {
+            return IsCable(k) ? model.cables[k - model.beams.size()].sapId : model.beams[k].sapId;
+        }
+        uint32_t Start(size_t k) const {
+            return IsCable(k) ? model.cables[k - model.beams.size()].startNodeId : model.beams[k].startNodeId;
+        }
+        uint32_t End(size_t k) const {
+            return IsCable(k) ? model.cables[k - model.beams.size()].endNodeId : model.beams[k].endNodeId;
+        }
+        int& StaadId(size_t k) {
+            return IsCable(k) ? model.cables[k - model.beams.size()].staadId : model.beams[k].staadId;
+        }
+    };
+
+    template <typename T>
+    void Compact(ModelVector<T>& items, const vector<uint8_t>& drop, size_t offset = 0) {
+        size_t out = 0;
+        for (size_t i = 0; i < items.size(); ++i) {
+            if (!drop[offset + i]) items[out++] = items[i];
+        }
+        items.resize(out);
+    }
+}
+
+size_t ValidationReport::Total() const {
+    size_t total = 0;
+    for (size_t count : counts) total += count;
+    return total;
+}
+
+void ValidationReport::PrintSummary(ostream& out) const {
+    for (size_t k = 0; k < static_cast<size_t>(IssueKind::Count); ++k) {
+        if (counts[k] > 0) {
+            out << "  " << counts[k] << " x " << IssueText(static_cast<IssueKind>(k)) << "\n";
+        }
+    }
+    if (renumberedMembers > 0) {
+        out << "  " << renumberedMembers << " member(s) renumbered\n";
+    }
+    if (droppedMembers > 0) {
+        out << "  " << droppedMembers << " member(s) dropped\n";
+    }
+    if (droppedSupports > 0) {
+        out << "  " << droppedSupports << " support(s) dropped\n";
+    }
+    out << "  " << substructures << " substructure(s), largest has " << largestSubstructure
+        << " joints; " << isolatedJoints << " joint(s) without members\n";
+}
+
+bool ValidationReport::WriteReport(const string& reportPath, const SAP2000Model& model) const {
+    ofstream report(reportPath);
+    if (!report.is_open()) {
+        cerr << "ERROR: Failed to write validation report: " << reportPath << endl;
+        return false;
+    }
+    report << "Model validation: " << Total() << " issue(s)\n";
+    PrintSummary(report);
+    report << "\n";
+    auto memberLabel = [&](uint32_t label, bool isCable) {
+        return (isCable ? model.cableLabels : model.frameLabels).Text(label);
+    };
+    for (const auto& issue : issues) {
+        const char* kind = issue.isCable ? "Cable " : "Frame ";
+        switch (issue.kind) {
+        case IssueKind::DuplicateJoint:
+        case IssueKind::UnknownSupportJoint:
+            report << "Joint " << model.jointLabels.Text(issue.id) << ": " << IssueText(issue.kind) << "\n";
+            break;
+        case IssueKind::ZeroLength:
+            report << kind << memberLabel(issue.id, issue.isCable) << ": " << IssueText(issue.kind) << "\n";
+            break;
+        case IssueKind::MissingJoint:
+            report << kind << memberLabel(issue.id, issue.isCable) << ": "
+                << IssueText(issue.kind) << " " << model.jointLabels.Text(issue.other) << "\n";
+            break;
+        default:
+            report << kind << memberLabel(issue.id, issue.isCable) << ": " << IssueText(issue.kind) << " "
+                << memberLabel(issue.other, issue.otherIsCable);
+            if (issue.otherIsCable != issue.isCable) report << (issue.otherIsCable ? " (cable)" : " (frame)");
+            report << "\n";
+            break;
+        }
+    }
+    size_t listed = issues.size();
+    if (Total() > listed) {
+        report << "... " << Total() - listed << " more not listed\n";
+    }
+    return true;
+}
+
+bool ModelValidator::Validate(SAP2000Model& model, const ValidationOptions& options, ValidationReport& report) {
+    report = ValidationReport();
+    auto addIssue = [&](IssueKind kind, uint32_t id, uint32_t other, bool isCable, bool otherIsCable = false) {
+        report.counts[static_cast<size_t>(kind)]++;
+        if (report.issues.size() < options.maxListedIssues) {
+            report.issues.push_back(ValidationIssue{ kind, id, other, isCable, otherIsCable });
+        }
+    };
+
+    // Joint lookup: label -> index into model.nodes, first row of each label
+    const size_t jointCount = model.nodes.size();
+    const vector<uint32_t> nodeByLabel = model.NodeByLabel();
+    vector<uint8_t> dropJoint(jointCount, 0);
+    for (uint32_t j = 0; j < jointCount; ++j) {
+        if (nodeByLabel[model.nodes[j].sapId] != j) {
+            dropJoint[j] = 1;
+            addIssue(IssueKind::DuplicateJoint, model.nodes[j].sapId, 0, false);
+        }
+    }
+    auto lookup = [&](uint32_t label) { return nodeByLabel[label]; };
+
+    // Resolve member ends and check lengths
+    MemberView members{ model };
+    const size_t memberCount = members.size();
+    vector<uint32_t> ji(memberCount), jj(memberCount);
+    vector<uint8_t> flags(memberCount, 0);
+    const double tol2 = options.zeroLengthTolerance * options.zeroLengthTolerance;
+    const double* x = model.coordinates.x.data();
+    const double* y = model.coordinates.y.data();
+    const double* z = model.coordinates.z.data();
+
+    Parallel::For(memberCount, [&](size_t begin, size_t end) {
+        for (size_t k = begin; k < end; ++k) {
+            ji[k] = lookup(members.Start(k));
+            jj[k] = lookup(members.End(k));
+            if (ji[k] == kNone || jj[k] == kNone) {
+                flags[k] = kMissingJoint;
+                continue;
+            }
+            double dx = x[jj[k]] - x[ji[k]];
+            double dy = y[jj[k]] - y[ji[k]];
+            double dz = z[jj[k]] - z[ji[k]];
+            if (ji[k] == jj[k] || dx * dx + dy * dy + dz * dz <= tol2) {
+                flags[k] = kZeroLength;
+            }
+        }
+    }, options.parallel);
+
+    // Members sharing a STAAD number: every occurrence after the first is
+    // flagged. A repeated row of the same frame or cable is a duplicate ID.
+    // The label tables already number cables apart from frames; should a
+    // frame and a cable still share a number, it is renumbered, not reported.
+    vector<uint32_t> byKey(memberCount);
+    iota(byKey.begin(), byKey.end(), 0u);
+    stable_sort(byKey.begin(), byKey.end(),
+        [&](uint32_t a, uint32_t b) { return members.StaadId(a) < members.StaadId(b); });
+    for (size_t n = 1; n < memberCount; ++n) {
+        uint32_t a = byKey[n - 1], b = byKey[n];
+        if (members.StaadId(a) != members.StaadId(b)) continue;
+        bool sameMember = members.IsCable(a) == members.IsCable(b) && members.Id(a) == members.Id(b);
+        flags[b] |= sameMember ? kDuplicateId : kNumberClash;
+    }
+
+    // Duplicate (i, j) pairs in either direction among otherwise valid members
+    auto pairKey = [&](uint32_t k) {
+        uint64_t a = min(ji[k], jj[k]), b = max(ji[k], jj[k]);
+        return (a << 32) | b;
+    };
+    vector<uint32_t> valid;
+    valid.reserve(memberCount);
+    for (uint32_t k = 0; k < memberCount; ++k) {
+        if (!(flags[k] & (kMissingJoint | kZeroLength))) valid.push_back(k);
+    }
+    stable_sort(valid.begin(), valid.end(),
+        [&](uint32_t a, uint32_t b) { return pairKey(a) < pairKey(b); });
+    vector<uint32_t> duplicateOf(memberCount, 0); // First member with the same joints
+    for (size_t n = 1; n < valid.size(); ++n) {
+        if (pairKey(valid[n]) == pairKey(valid[n - 1])) {
+            flags[valid[n]] |= kDuplicateMember;
+            duplicateOf[valid[n]] = (flags[valid[n - 1]] & kDuplicateMember) ? duplicateOf[valid[n - 1]] : valid[n - 1];
+        }
+    }
+
+    for (size_t k = 0; k < memberCount; ++k) {
+        if (flags[k] & kMissingJoint) {
+            addIssue(IssueKind::MissingJoint, members.Id(k),
+                ji[k] == kNone ? members.Start(k) : members.End(k), members.IsCable(k));
+        }
+        if (flags[k] & kZeroLength) addIssue(IssueKind::ZeroLength, members.Id(k), 0, members.IsCable(k));
+        if (flags[k] & kDuplicateId) {
+            addIssue(IssueKind::DuplicateMemberId, members.Id(k), members.Id(k), members.IsCable(k), members.IsCable(k));
+        }
+        if (flags[k] & kDuplicateMember) {
+            uint32_t first = duplicateOf[k];
+            addIssue(IssueKind::DuplicateMember, members.Id(k), members.Id(first), members.IsCable(k), members.IsCable(first));
+        }
+    }
+
+    vector<uint8_t> dropRestraint(model.restraints.size(), 0);
+    for (size_t r = 0; r < model.restraints.size(); ++r) {
+        if (lookup(model.restraints[r].jointId) == kNone) {
+            dropRestraint[r] = 1;
+            addIssue(IssueKind::UnknownSupportJoint, model.restraints[r].jointId, 0, false);
+        }
+    }
+    vector<uint8_t> dropSpring(model.springs.size(), 0);
+    for (size_t s = 0; s < model.springs.size(); ++s) {
+        if (lookup(model.springs[s].jointId) == kNone) {
+            dropSpring[s] = 1;
+            addIssue(IssueKind::UnknownSupportJoint, model.springs[s].jointId, 0, false);
+        }
+    }
+
+    // Members that survive the policy; renumbered duplicates stay under Fix
+    const uint8_t fatal = options.policy == ValidationPolicy::Fix
+        ? uint8_t(kMissingJoint | kZeroLength | kDuplicateMember)
+        : uint8_t(kMissingJoint | kZeroLength | kDuplicateMember | kDuplicateId);
+    vector<uint8_t> dropMember(memberCount, 0);
+    for (size_t k = 0; k < memberCount; ++k) dropMember[k] = (flags[k] & fatal) ? 1 : 0;
+
+    // Connectivity of what will be converted
+    ConcurrentUnionFind components(jointCount);
+    Parallel::For(memberCount, [&](size_t begin, size_t end) {
+        for (size_t k = begin; k < end; ++k) {
+            if (!dropMember[k]) components.Unite(ji[k], jj[k]);
+        }
+    }, options.parallel);
+
+    vector<uint8_t> touched(jointCount, 0);
+    for (size_t k = 0; k < memberCount; ++k) {
+        if (!dropMember[k]) touched[ji[k]] = touched[jj[k]] = 1;
+    }
+    vector<uint32_t> componentSize(jointCount, 0);
+    for (size_t j = 0; j < jointCount; ++j) {
+        if (dropJoint[j]) continue;
+        if (!touched[j]) {
+            report.isolatedJoints++;
+            continue;
+        }
+        uint32_t& size = componentSize[components.Find(static_cast<uint32_t>(j))];
+        if (size++ == 0) report.substructures++;
+        report.largestSubstructure = max<size_t>(report.largestSubstructure, size);
+    }
+
+    if (report.Total() > 0 && options.policy == ValidationPolicy::Abort) {
+        return false;
+    }
+
+    // Clashing frames and cables get fresh numbers under every policy,
+    // duplicate IDs only under Fix
+    const uint8_t renumber = options.policy == ValidationPolicy::Fix
+        ? uint8_t(kNumberClash | kDuplicateId)
+        : kNumberClash;
+    int nextId = 0;
+    for (size_t k = 0; k < memberCount; ++k) nextId = max(nextId, members.StaadId(k));
+    for (size_t k = 0; k < memberCount; ++k) {
+        if (!dropMember[k] && (flags[k] & renumber)) {
+            members.StaadId(k) = ++nextId;
+            report.renumberedMembers++;
+        }
+    }
+    for (size_t k = 0; k < memberCount; ++k) report.droppedMembers += dropMember[k];
+    for (uint8_t drop : dropRestraint) report.droppedSupports += drop;
+    for (uint8_t drop : dropSpring) report.droppedSupports += drop;
+
+    if (report.counts[static_cast<size_t>(IssueKind::DuplicateJoint)] > 0) {
+        Compact(model.nodes, dropJoint);
+        Compact(model.coordinates.x, dropJoint);
+        Compact(model.coordinates.y, dropJoint);
+        Compact(model.coordinates.z, dropJoint);
+    }
+    const size_t beamCount = model.beams.size();
+    Compact(model.beams, dropMember);
+    Compact(model.cables, dropMember, beamCount);
+    Compact(model.restraints, dropRestraint);
+    Compact(model.springs, dropSpring);
+    return true;
+}
@@ -0,0 +1,59 @@
+#pragma once
+#include <string>
+#include <vector>
+#include <iosfwd>
+#include "SAP2000Model.h"
+
+enum class ValidationPolicy {
+    Drop,   // Remove every offending member, restraint or spring
+    Fix,    // Like Drop, but give duplicate member IDs fresh STAAD numbers instead
+    Abort   // Refuse to convert if anything is wrong
+};
+
+struct ValidationOptions {
+    ValidationPolicy policy = ValidationPolicy::Drop;
+    double zeroLengthTolerance = 1e-6; // In model length units
+    size_t maxListedIssues = 1000;
+    bool parallel = true;
+};
+
+enum class IssueKind : uint8_t {
+    DuplicateJoint,
+    MissingJoint,
+    DuplicateMemberId,
+    ZeroLength,
+    DuplicateMember,
+    UnknownSupportJoint,
+    Count
+};
+
+struct ValidationIssue {
+    IssueKind kind;
+    uint32_t id;    // Joint or member label
+    uint32_t other; // Related label: missing joint, first duplicate, ...
+    bool isCable;
+    bool otherIsCable; // Which member table `other` is in, for duplicates
+};
+
+struct ValidationReport {
+    size_t counts[static_cast<size_t>(IssueKind::Count)] = {};
+    std::vector<ValidationIssue> issues; // First maxListedIssues only
+    size_t substructures = 0;            // Connected groups of joints with members
+    size_t largestSubstructure = 0;      // Joints in the biggest one
+    size_t isolatedJoints = 0;           // Joints no member touches
+    size_t renumberedMembers = 0;        // Given a fresh STAAD number
+    size_t droppedMembers = 0;           // Removed by the policy
+    size_t droppedSupports = 0;          // Restraints and springs on missing joints
+
+    size_t Total() const;
+    void PrintSummary(std::ostream& out) const;
+    // Labels are printed from the model's label tables
+    bool WriteReport(const std::string& reportPath, const SAP2000Model& model) const;
+};
+
+namespace ModelValidator {
+    // Checks joint references, duplicate IDs, zero-length and duplicate members
+    // and connectivity, then applies the policy to the model. Returns false
+    // when the policy is Abort and an error was found.
+    bool Validate(SAP2000Model& model, const ValidationOptions& options, ValidationReport& report);
+}
@@ -0,0 +1,263 @@
+#include "ModelVerifier.h"
+#include "Parallel.h"
+#include <algorithm>
+#include <cctype>
+#include <charconv>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <fstream>
+#include <iostream>
+#include <numeric>
+#include <utility>
+
+using namespace std;
+
+namespace {
+    const uint32_t kNone = UINT32_MAX;
+
+    const char* KindText(MismatchKind kind) {
+        switch (kind) {
+        case MismatchKind::MissingNode: return "node not in STAAD";
+        case MismatchKind::NodeMoved: return "node coordinates differ";
+        case MismatchKind::ExtraNode: return "node only in STAAD";
+        case MismatchKind::MissingMember: return "member not in STAAD";
+        case MismatchKind::WrongIncidence: return "member incidences differ";
+        case MismatchKind::ReversedMember: return "member reversed";
+        case MismatchKind::ExtraMember: return "member only in STAAD";
+        default: return "unknown";
+        }
+    }
+
+    // Parses "n v1 v2 ...; n v1 v2 ...;" entries of one .std data block
+    template <typename T, size_t N>
+    void ParseEntries(const string& line, vector<int>& ids, vector<T>* values[N]) {
+        const char* p = line.data();
+        const char* end = p + line.size();
+        while (p < end) {
+            const char* entryEnd = find(p, end, ';');
+            int id = 0;
+            T parsed[N] = {};
+            bool ok = true;
+            const char* q = p;
+            auto skip = [&] { while (q < entryEnd && isspace(static_cast<unsigned char>(*q))) ++q; };
+            skip();
+            auto result = from_chars(q, entryEnd, id);
+            ok = result.ec == errc() && q != entryEnd;
+            q = result.ptr;
+            for (size_t v = 0; ok && v < N; ++v) {
+                skip();
+                auto r = from_chars(q, entryEnd, parsed[v]);
+                ok = r.ec == errc();
+                q = r.ptr;
+            }
+            if (ok) {
+                ids.push_back(id);
+                for (size_t v = 0; v < N; ++v) values[v]->push_back(parsed[v]);
+            }
+            p = entryEnd + (entryEnd < end ? 1 : 0);
+        }
+    }
+
+    // (id, index) sorted by id
+    vector<pair<int, uint32_t>> SortedIndex(const vector<int>& ids) {
+        vector<pair<int, uint32_t>> index(ids.size());
+        for (uint32_t k = 0; k < ids.size(); ++k) index[k] = { ids[k], k };
+        sort(index.begin(), index.end());
+        return index;
+    }
+
+    uint32_t Find(const vector<pair<int, uint32_t>>& index, int id) {
+        auto it = lower_bound(index.begin(), index.end(), make_pair(id, 0u));
+        return (it != index.end() && it->first == id) ? it->second : kNone;
+    }
+}
+
+size_t VerificationReport::Total() const {
+    size_t total = 0;
+    for (size_t count : counts) total += count;
+    return total;
+}
+
+void VerificationReport::PrintSummary(ostream& out) const {
+    out << "  " << nodesChecked << " nodes, " << membersChecked << " members checked in "
+        << milliseconds << " ms\n";
+    for (size_t k = 0; k < static_cast<size_t>(MismatchKind::Count); ++k) {
+        if (counts[k] > 0) {
+            out << "  " << KindText(static_cast<MismatchKind>(k)) << ": " << counts[k] << "\n";
+        }
+    }
+}
+
+bool VerificationReport::WriteReport(const string& reportPath) const {
+    ofstream report(reportPath);
+    if (!report.is_open()) {
+        cerr << "ERROR: Could not write verification report: " << reportPath << endl;
+        return false;
+    }
+    report << "STAAD read-back verification\n";
+    PrintSummary(report);
+    report << "\n";
+    for (const auto& m : mismatches) {
+        report << KindText(m.kind) << ": " << m.staadId;
+        if (m.kind == MismatchKind::NodeMoved) {
+            report << " by " << m.distance;
+        }
+        else if (m.kind == MismatchKind::WrongIncidence || m.kind == MismatchKind::ReversedMember) {
+            report << " expected " << m.expected[0] << "-" << m.expected[1]
+                << ", found " << m.found[0] << "-" << m.found[1];
+        }
+        report << "\n";
+    }
+    if (mismatches.size() < Total()) {
+        report << "... " << Total() - mismatches.size() << " more not listed\n";
+    }
+    return true;
+}
+
+bool ModelVerifier::ReadStdFile(const string& stdPath, StdGeometry& geometry) {
+    ifstream input(stdPath);
+    if (!input.is_open()) {
+        cerr << "ERROR: Could not open " << stdPath << " for verification" << endl;
+        return false;
+    }
+
+    enum { None, Joints, Members } block = None;
+    vector<double>* coordinates[3] = { &geometry.x, &geometry.y, &geometry.z };
+    vector<int>* incidences[2] = { &geometry.startNodes, &geometry.endNodes };
+    string line, entries;
+    while (getline(input, line)) {
+        line.erase(remove(line.begin(), line.end(), '\r'), line.end());
+        size_t first = line.find_first_not_of(" \t");
+        if (first == string::npos || line[first] == '*') continue;
+
+        // A trailing '-' continues the entry on the next line
+        size_t last = line.find_last_not_of(" \t");
+        if (block != None && line[last] == '-') {
+            entries.append(line, 0, last);
+            entries += ' ';
+            continue;
+        }
+        if (!entries.empty()) {
+            line.insert(0, entries);
+            entries.clear();
+            first = 0;
+        }
+
+        // Any command word ends the current data block
+        if (isalpha(static_cast<unsigned char>(line[first]))) {
+            if (line.compare(first, 17, "JOINT COORDINATES") == 0) block = Joints;
+            else if (line.compare(first, 17, "MEMBER INCIDENCES") == 0) block = Members;
+            else block = None;
+            continue;
+        }
+        if (block == Joints) ParseEntries<double, 3>(line, geometry.nodeIds, coordinates);
+        else if (block == Members) ParseEntries<int, 2>(line, geometry.memberIds, incidences);
+    }
+    return true;
+}
+
+bool ModelVerifier::Compare(const SAP2000Model& model, const StdGeometry& created,
+    const VerificationOptions& options, VerificationReport& report) {
+    auto start = chrono::steady_clock::now();
+
+    // Expected geometry by STAAD number; members are beams then cables
+    const size_t nodeCount = model.nodes.size();
+    const size_t memberCount = model.beams.size() + model.cables.size();
+    vector<int> expectedNodes(nodeCount);
+    for (size_t j = 0; j < nodeCount; ++j) expectedNodes[j] = model.nodes[j].staadId;
+    const vector<uint32_t> nodeByLabel = model.NodeByLabel();
+
+    vector<int> expectedMembers(memberCount), expectedStart(memberCount), expectedEnd(memberCount);
+    auto addMember = [&](size_t k, int staadId, uint32_t startJoint, uint32_t endJoint) {
+        uint32_t i = nodeByLabel[startJoint];
+        uint32_t j = nodeByLabel[endJoint];
+        expectedMembers[k] = staadId;
+        expectedStart[k] = i == kNone ? 0 : expectedNodes[i];
+        expectedEnd[k] = j == kNone ? 0 : expectedNodes[j];
+    };
+    for (size_t k = 0; k < model.beams.size(); ++k) {
+        const Beam& b = model.beams[k];
+        addMember(k, b.staadId, b.startNodeId, b.endNodeId);
+    }
+    for (size_t k = 0; k < model.cables.size(); ++k) {
+        const Cable& c = model.cables[k];
+        addMember(model.beams.size() + k, c.staadId, c.startNodeId, c.endNodeId);
+    }
+
+    auto createdNodes = SortedIndex(created.nodeIds);
+    auto createdMembers = SortedIndex(created.memberIds);
+
+    // Per-entity status in parallel, gathered serially in model order
+    vector<uint8_t> nodeStatus(nodeCount, 0xff), memberStatus(memberCount, 0xff);
+    vector<double> distance(nodeCount, 0.0);
+    vector<uint32_t> nodeMatch(nodeCount, kNone), memberMatch(memberCount, kNone);
+    const double tol2 = options.tolerance * options.tolerance;
+
+    Parallel::For(nodeCount, [&](size_t begin, size_t end) {
+        for (size_t j = begin; j < end; ++j) {
+            uint32_t c = Find(createdNodes, expectedNodes[j]);
+            nodeMatch[j] = c;
+            if (c == kNone) {
+                nodeStatus[j] = static_cast<uint8_t>(MismatchKind::MissingNode);
+                continue;
+            }
+            double dx = created.x[c] - model.nodes[j].x;
+            double dy = created.y[c] - model.nodes[j].y;
+            double dz = created.z[c] - model.nodes[j].z;
+            double d2 = dx * dx + dy * dy + dz * dz;
+            if (d2 > tol2) {
+                nodeStatus[j] = static_cast<uint8_t>(MismatchKind::NodeMoved);
+                distance[j] = sqrt(d2);
+            }
+        }
+    }, options.parallel);
+
+    Parallel::For(memberCount, [&](size_t begin, size_t end) {
+        for (size_t k = begin; k < end; ++k) {
+            uint32_t c = Find(createdMembers, expectedMembers[k]);
+            memberMatch[k] = c;
+            if (c == kNone) {
+                memberStatus[k] = static_cast<uint8_t>(MismatchKind::MissingMember);
+                continue;
+            }
+            int a = created.startNodes[c], b = created.endNodes[c];
+            if (a == expectedStart[k] && b == expectedEnd[k]) continue;
+            memberStatus[k] = static_cast<uint8_t>(a == expectedEnd[k] && b == expectedStart[k] ?
+                MismatchKind::ReversedMember : MismatchKind::WrongIncidence);
+        }
+    }, options.parallel);
+
+    auto add = [&](MismatchKind kind, int id, double d, int e0, int e1, int f0, int f1) {
+        report.counts[static_cast<size_t>(kind)]++;
+        if (report.mismatches.size() < options.maxListed) {
+            report.mismatches.push_back(Mismatch{ kind, id, d, { e0, e1 }, { f0, f1 } });
+        }
+    };
+    vector<uint8_t> nodeSeen(created.nodeIds.size(), 0), memberSeen(created.memberIds.size(), 0);
+    for (uint32_t c : nodeMatch) if (c != kNone) nodeSeen[c] = 1;
+    for (uint32_t c : memberMatch) if (c != kNone) memberSeen[c] = 1;
+
+    for (size_t j = 0; j < nodeCount; ++j) {
+        if (nodeStatus[j] != 0xff) add(static_cast<MismatchKind>(nodeStatus[j]), expectedNodes[j], distance[j], 0, 0, 0, 0);
+    }
+    for (size_t c = 0; c < nodeSeen.size(); ++c) {
+        if (!nodeSeen[c]) add(MismatchKind::ExtraNode, created.nodeIds[c], 0.0, 0, 0, 0, 0);
+    }
+    for (size_t k = 0; k < memberCount; ++k) {
+        if (memberStatus[k] == 0xff) continue;
+        uint32_t c = memberMatch[k];
+        int f0 = c == kNone ? 0 : created.startNodes[c];
+        int f1 = c == kNone ? 0 : created.endNodes[c];
+        add(static_cast<MismatchKind>(memberStatus[k]), expectedMembers[k], 0.0,
+            expectedStart[k], expectedEnd[k], f0, f1);
+    }
+    for (size_t c = 0; c < memberSeen.size(); ++c) {
+        if (!memberSeen[c]) add(MismatchKind::ExtraMember, created.memberIds[c], 0.0, 0, 0, 0, 0);
+    }
+
+    report.nodesChecked = nodeCount;
+    report.membersChecked = memberCount;
+    report.milliseconds = chrono::duration<double, milli>(chrono::steady_clock::now() - start).count();
+    return report.Total() == 0;
+}
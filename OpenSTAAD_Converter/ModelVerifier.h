@@ -0,0 +1,60 @@
+#pragma once
+#include <string>
+#include <vector>
+#include <iosfwd>
+#include "SAP2000Model.h"
+
+enum class MismatchKind : uint8_t {
+    MissingNode,
+    NodeMoved,
+    ExtraNode,
+    MissingMember,
+    WrongIncidence,
+    ReversedMember,
+    ExtraMember,
+    Count
+};
+
+struct Mismatch {
+    MismatchKind kind;
+    int staadId;        // Node or member number in STAAD
+    double distance;    // NodeMoved only
+    int expected[2];    // Incidences from the model
+    int found[2];       // Incidences read back
+};
+
+struct VerificationOptions {
+    double tolerance = 1e-3; // Absolute, in model length units
+    size_t maxListed = 1000;
+    bool parallel = true;
+};
+
+struct VerificationReport {
+    size_t counts[static_cast<size_t>(MismatchKind::Count)] = {};
+    std::vector<Mismatch> mismatches; // First maxListed only
+    size_t nodesChecked = 0;
+    size_t membersChecked = 0;
+    double milliseconds = 0.0;
+
+    size_t Total() const;
+    void PrintSummary(std::ostream& out) const;
+    bool WriteReport(const std::string& reportPath) const;
+};
+
+// Geometry as STAAD wrote it to the .std input file
+struct StdGeometry {
+    std::vector<int> nodeIds;
+    std::vector<double> x, y, z;
+    std::vector<int> memberIds;
+    std::vector<int> startNodes, endNodes;
+};
+
+namespace ModelVerifier {
+    // Reads JOINT COORDINATES and MEMBER INCIDENCES from a saved .std file.
+    bool ReadStdFile(const std::string& stdPath, StdGeometry& geometry);
+
+    // Compares nodes and member incidences of the model, by STAAD number,
+    // against what STAAD holds. Returns true when nothing differs.
+    bool Compare(const SAP2000Model& model, const StdGeometry& created,
+        const VerificationOptions& options, VerificationReport& report);
+}
@@ -0,0 +1,37 @@
+#pragma once
+#include <algorithm>
+#include <thread>
+#include <vector>
+
+namespace Parallel {
+    // Below this many items per worker, threads cost more than they save.
+    const size_t kMinChunk = size_t(1) << 16;
+
+    inline unsigned WorkerCount(size_t count, bool parallel = true) {
+        if (!parallel || count < 2 * kMinChunk) return 1;
+        unsigned hw = std::max(1u, std::thread::hardware_concurrency());
+        return static_cast<unsigned>(std::min<size_t>(hw, count / kMinChunk));
+    }
+
+    // Runs fn(begin, end) over contiguous chunks of [0, count). Each index is
+    // visited exactly once, so per-element kernels give the same result as a
+    // single serial call fn(0, count).
+    template <typename Fn>
+    void For(size_t count, Fn fn, bool parallel = true) {
+        unsigned workers = WorkerCount(count, parallel);
+        if (workers <= 1) {
+            fn(size_t(0), count);
+            return;
+        }
+        size_t chunk = (count + workers - 1) / workers;
+        std::vector<std::thread> threads;
+        threads.reserve(workers);
+        for (unsigned w = 0; w < workers; ++w) {
+            size_t begin = w * chunk;
+            size_t end = std::min(count, begin + chunk);
+            if (begin >= end) break;
+            threads.emplace_back(fn, begin, end);
+        }
+        for (auto& thread : threads) thread.join();
+    }
+}
@@ -0,0 +1,227 @@
+#include "Renumbering.h"
+#include "Parallel.h"
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <fstream>
+#include <iostream>
+#include <numeric>
+#include <utility>
+
+using namespace std;
+
+namespace {
+    const uint32_t kNone = UINT32_MAX;
+
+    // Undirected joint graph in compressed sparse row form
+    struct Graph {
+        vector<uint32_t> offsets; // size n + 1
+        vector<uint32_t> targets;
+        uint32_t Degree(uint32_t v) const { return offsets[v + 1] - offsets[v]; }
+    };
+
+    // Breadth-first level structure from root, limited to unvisited joints.
+    // Returns the joints in BFS order; levelOf is stamped with `stamp`.
+    uint32_t BuildLevels(const Graph& g, uint32_t root, const vector<uint8_t>& visited,
+        vector<uint32_t>& stampOf, uint32_t stamp, vector<uint32_t>& queue, uint32_t& lastLevelStart) {
+        queue.clear();
+        queue.push_back(root);
+        stampOf[root] = stamp;
+        size_t head = 0;
+        uint32_t depth = 0;
+        lastLevelStart = 0;
+        while (head < queue.size()) {
+            size_t levelEnd = queue.size();
+            lastLevelStart = static_cast<uint32_t>(head);
+            for (; head < levelEnd; ++head) {
+                uint32_t v = queue[head];
+                for (uint32_t e = g.offsets[v]; e < g.offsets[v + 1]; ++e) {
+                    uint32_t w = g.targets[e];
+                    if (!visited[w] && stampOf[w] != stamp) {
+                        stampOf[w] = stamp;
+                        queue.push_back(w);
+                    }
+                }
+            }
+            if (queue.size() > levelEnd) depth++;
+        }
+        return depth;
+    }
+
+    // George-Liu pseudo-peripheral joint: restart from the lowest-degree joint
+    // of the last level while the eccentricity keeps growing.
+    uint32_t PseudoPeripheral(const Graph& g, uint32_t start, const vector<uint8_t>& visited,
+        vector<uint32_t>& stampOf, uint32_t& stamp, vector<uint32_t>& queue) {
+        uint32_t root = start;
+        uint32_t lastLevel = 0;
+        uint32_t depth = BuildLevels(g, root, visited, stampOf, ++stamp, queue, lastLevel);
+        for (int iteration = 0; iteration < 8; ++iteration) {
+            uint32_t candidate = queue[lastLevel];
+            for (size_t i = lastLevel; i < queue.size(); ++i) {
+                if (g.Degree(queue[i]) < g.Degree(candidate)) candidate = queue[i];
+            }
+            uint32_t candidateDepth = BuildLevels(g, candidate, visited, stampOf, ++stamp, queue, lastLevel);
+            if (candidateDepth <= depth) break;
+            root = candidate;
+            depth = candidateDepth;
+        }
+        return root;
+    }
+
+    pair<size_t, size_t> BandwidthAndProfile(const Graph& g, const vector<uint32_t>& position) {
+        size_t bandwidth = 0;
+        size_t profile = 0;
+        const uint32_t n = static_cast<uint32_t>(position.size());
+        for (uint32_t v = 0; v < n; ++v) {
+            uint32_t row = position[v];
+            uint32_t first = row;
+            for (uint32_t e = g.offsets[v]; e < g.offsets[v + 1]; ++e) {
+                uint32_t column = position[g.targets[e]];
+                first = min(first, column);
+                bandwidth = max<size_t>(bandwidth, row > column ? row - column : column - row);
+            }
+            profile += row - first;
+        }
+        return { bandwidth, profile };
+    }
+}
+
+RenumberReport Renumbering::Apply(SAP2000Model& model, bool parallel) {
+    RenumberReport report;
+    auto started = chrono::steady_clock::now();
+    const uint32_t n = static_cast<uint32_t>(model.nodes.size());
+    const size_t beamCount = model.beams.size();
+    const size_t memberCount = beamCount + model.cables.size();
+
+    // Joint label -> joint index
+    const vector<uint32_t> nodeByLabel = model.NodeByLabel();
+    auto lookup = [&](uint32_t label) { return nodeByLabel[label]; };
+
+    vector<uint32_t> ends(2 * memberCount);
+    Parallel::For(memberCount, [&](size_t begin, size_t end) {
+        for (size_t k = begin; k < end; ++k) {
+            if (k < beamCount) {
+                ends[2 * k] = lookup(model.beams[k].startNodeId);
+                ends[2 * k + 1] = lookup(model.beams[k].endNodeId);
+            }
+            else {
+                ends[2 * k] = lookup(model.cables[k - beamCount].startNodeId);
+                ends[2 * k + 1] = lookup(model.cables[k - beamCount].endNodeId);
+            }
+        }
+    }, parallel);
+
+    // CSR adjacency, both directions
+    Graph g;
+    g.offsets.assign(n + 1, 0);
+    for (size_t k = 0; k < memberCount; ++k) {
+        uint32_t a = ends[2 * k], b = ends[2 * k + 1];
+        if (a == kNone || b == kNone || a == b) continue;
+        g.offsets[a + 1]++;
+        g.offsets[b + 1]++;
+    }
+    partial_sum(g.offsets.begin(), g.offsets.end(), g.offsets.begin());
+    g.targets.resize(g.offsets[n]);
+    vector<uint32_t> fill(g.offsets.begin(), g.offsets.end() - 1);
+    for (size_t k = 0; k < memberCount; ++k) {
+        uint32_t a = ends[2 * k], b = ends[2 * k + 1];
+        if (a == kNone || b == kNone || a == b) continue;
+        g.targets[fill[a]++] = b;
+        g.targets[fill[b]++] = a;
+    }
+    // Cuthill-McKee visits neighbours by increasing degree
+    Parallel::For(n, [&](size_t begin, size_t end) {
+        for (size_t v = begin; v < end; ++v) {
+            sort(g.targets.begin() + g.offsets[v], g.targets.begin() + g.offsets[v + 1],
+                [&](uint32_t a, uint32_t b) {
+                    return g.Degree(a) != g.Degree(b) ? g.Degree(a) < g.Degree(b) : a < b;
+                });
+        }
+    }, parallel);
+
+    // Before: the default STAAD numbers, i.e. ascending number order
+    vector<uint32_t> byNumber(n);
+    iota(byNumber.begin(), byNumber.end(), 0u);
+    sort(byNumber.begin(), byNumber.end(), [&](uint32_t a, uint32_t b) {
+        return model.nodes[a].staadId != model.nodes[b].staadId
+            ? model.nodes[a].staadId < model.nodes[b].staadId : a < b;
+    });
+    vector<uint32_t> position(n);
+    for (uint32_t r = 0; r < n; ++r) position[byNumber[r]] = r;
+    tie(report.bandwidthBefore, report.profileBefore) = BandwidthAndProfile(g, position);
+
+    // Cuthill-McKee per component, starting from a pseudo-peripheral joint
+    vector<uint32_t> order;
+    order.reserve(n);
+    vector<uint8_t> visited(n, 0);
+    vector<uint32_t> stampOf(n, 0);
+    vector<uint32_t> queue;
+    uint32_t stamp = 0;
+    for (uint32_t r = 0; r < n; ++r) {
+        uint32_t seed = byNumber[r];
+        if (visited[seed]) continue;
+        uint32_t root = PseudoPeripheral(g, seed, visited, stampOf, stamp, queue);
+        size_t head = order.size();
+        order.push_back(root);
+        visited[root] = 1;
+        while (head < order.size()) {
+            uint32_t v = order[head++];
+            for (uint32_t e = g.offsets[v]; e < g.offsets[v + 1]; ++e) {
+                uint32_t w = g.targets[e];
+                if (!visited[w]) {
+                    visited[w] = 1;
+                    order.push_back(w);
+                }
+            }
+        }
+    }
+    reverse(order.begin(), order.end());
+
+    for (uint32_t r = 0; r < n; ++r) position[order[r]] = r;
+    tie(report.bandwidthAfter, report.profileAfter) = BandwidthAndProfile(g, position);
+
+    for (uint32_t v = 0; v < n; ++v) {
+        model.nodes[v].staadId = static_cast<int>(position[v]) + 1;
+    }
+
+    // Members follow their lowest joint so element data stays local too
+    vector<uint32_t> members(memberCount);
+    iota(members.begin(), members.end(), 0u);
+    auto memberKey = [&](uint32_t k) {
+        uint32_t a = ends[2 * k] == kNone ? kNone : position[ends[2 * k]];
+        uint32_t b = ends[2 * k + 1] == kNone ? kNone : position[ends[2 * k + 1]];
+        return make_pair(min(a, b), max(a, b));
+    };
+    stable_sort(members.begin(), members.end(),
+        [&](uint32_t a, uint32_t b) { return memberKey(a) < memberKey(b); });
+    for (uint32_t r = 0; r < memberCount; ++r) {
+        uint32_t k = members[r];
+        if (k < beamCount) model.beams[k].staadId = static_cast<int>(r) + 1;
+        else model.cables[k - beamCount].staadId = static_cast<int>(r) + 1;
+    }
+
+    report.seconds = chrono::duration<double>(chrono::steady_clock::now() - started).count();
+    cout << "Renumbered " << n << " joints and " << memberCount << " members in "
+        << report.seconds << " s: bandwidth " << report.bandwidthBefore << " -> " << report.bandwidthAfter
+        << ", profile " << report.profileBefore << " -> " << report.profileAfter << endl;
+    return report;
+}
+
+bool Renumbering::WriteMap(const SAP2000Model& model, const string& mapPath) {
+    ofstream map(mapPath);
+    if (!map.is_open()) {
+        cerr << "ERROR: Failed to write renumbering map: " << mapPath << endl;
+        return false;
+    }
+    map << "kind,sap,staad\n";
+    for (const auto& node : model.nodes) {
+        map << "joint," << model.jointLabels.Text(node.sapId) << "," << node.staadId << "\n";
+    }
+    for (const auto& beam : model.beams) {
+        map << "frame," << model.frameLabels.Text(beam.sapId) << "," << beam.staadId << "\n";
+    }
+    for (const auto& cable : model.cables) {
+        map << "cable," << model.cableLabels.Text(cable.sapId) << "," << cable.staadId << "\n";
+    }
+    return true;
+}
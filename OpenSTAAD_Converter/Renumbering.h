@@ -0,0 +1,21 @@
+#pragma once
+#include <string>
+#include "SAP2000Model.h"
+
+struct RenumberReport {
+    size_t bandwidthBefore = 0;
+    size_t bandwidthAfter = 0;
+    size_t profileBefore = 0;
+    size_t profileAfter = 0;
+    double seconds = 0.0;
+};
+
+namespace Renumbering {
+    // Orders joints by Reverse Cuthill-McKee over the frame and cable graph and
+    // stores the result in Node::staadId (1-based). Members get STAAD IDs in
+    // the order of their lowest joint. SAP IDs are left untouched.
+    RenumberReport Apply(SAP2000Model& model, bool parallel = true);
+
+    // SAP -> STAAD ID map for traceability, one "kind,sap,staad" line each.
+    bool WriteMap(const SAP2000Model& model, const std::string& mapPath);
+}
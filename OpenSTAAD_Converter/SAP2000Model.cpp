@@ -0,0 +1,167 @@
+#include "SAP2000Model.h"
+#include "InputStream.h"
+#include <iostream>
+
+using namespace std;
+
+namespace {
+    size_t ArenaSize(const SectionRowCounts& rows) {
+        // One slot of alignment slack per table
+        const size_t slack = 12 * alignof(max_align_t);
+        return rows.joint * sizeof(Node) +
+            rows.connection * sizeof(Beam) +
+            rows.cable * sizeof(Cable) +
+            rows.support * sizeof(JointRestraint) +
+            rows.spring * sizeof(JointSpring) +
+            rows.group * sizeof(GroupAssignment) +
+            rows.localaxes * sizeof(FrameLocalAxis) +
+            rows.insertion * sizeof(FrameInsertion) +
+            rows.combination * sizeof(ComboTerm) +
+            rows.joint * 3 * sizeof(double) +
+            slack;
+    }
+}
+
+AllocationCounter::AllocationCounter(pmr::memory_resource* upstream)
+    : upstream_(upstream) {
+}
+
+void* AllocationCounter::do_allocate(size_t bytes, size_t alignment) {
+    void* p = upstream_->allocate(bytes, alignment);
+    allocations_++;
+    bytesInUse_ += bytes;
+    if (bytesInUse_ > peakBytes_) peakBytes_ = bytesInUse_;
+    return p;
+}
+
+void AllocationCounter::do_deallocate(void* p, size_t bytes, size_t alignment) {
+    upstream_->deallocate(p, bytes, alignment);
+    bytesInUse_ -= bytes;
+}
+
+bool AllocationCounter::do_is_equal(const pmr::memory_resource& other) const noexcept {
+    return this == &other;
+}
+
+SAP2000Model::SAP2000Model(const SectionPositions& positions)
+    : sections(positions),
+      arena_(ArenaSize(positions.rows), &counter_),
+      nodes(&arena_),
+      beams(&arena_),
+      cables(&arena_),
+      restraints(&arena_),
+      springs(&arena_),
+      groups(&arena_),
+      localAxes(&arena_),
+      insertions(&arena_),
+      comboTerms(&arena_),
+      coordinates(&arena_) {
+}
+
+void SAP2000Model::Load(InputText& text) {
+    text.Mark(sections.offsets);
+
+    // Labels are mostly short numbers; the pool grows if they are not
+    jointLabels.Reserve(sections.rows.joint, sections.rows.joint * 8);
+    frameLabels.Reserve(sections.rows.connection, sections.rows.connection * 8);
+    cableLabels.Reserve(sections.rows.cable, sections.rows.cable * 8);
+
+    units = SAP2000Parser::ExtractUnits(text, sections.icontrol + 1);
+    nodes = SAP2000Parser::ExtractNodes(text, sections.ijoint + 1, jointLabels,
+        sections.rows.joint, &arena_, &errors);
+    beams = SAP2000Parser::ExtractBeams(text, sections.iconnection + 1, frameLabels, jointLabels,
+        sections.rows.connection, &arena_, &errors);
+    cables = SAP2000Parser::ExtractCables(text, sections.icable + 1, cableLabels, jointLabels,
+        sections.rows.cable, &arena_, &errors);
+    restraints = SAP2000Parser::ExtractJointRestraints(text, sections.isupport + 1, jointLabels,
+        sections.rows.support, &arena_, &errors);
+    springs = SAP2000Parser::ExtractJointSprings(text, sections.ispring + 1, jointLabels,
+        sections.rows.spring, &arena_, &errors);
+    groups = SAP2000Parser::ExtractGroups(text, sections.igroup + 1, jointLabels, frameLabels,
+        cableLabels, groupNames, sections.rows.group, &arena_, &errors);
+    localAxes = SAP2000Parser::ExtractFrameLocalAxes(text, sections.ilocalaxes + 1, frameLabels,
+        sections.rows.localaxes, &arena_, &errors);
+    insertions = SAP2000Parser::ExtractFrameInsertions(text, sections.iinsertion + 1, frameLabels,
+        sections.rows.insertion, &arena_, &errors);
+    patternNames = SAP2000Parser::ExtractLoadPatterns(text, sections.ipattern + 1);
+    comboTerms = SAP2000Parser::ExtractCombinations(text, sections.icombination + 1,
+        patternNames, comboNames, comboKinds, sections.rows.combination, &arena_, &errors);
+
+    // Default STAAD numbers; renumbering and validation may change them later
+    jointLabels.NumberLabels();
+    frameLabels.NumberLabels();
+    cableLabels.NumberLabels(&frameLabels);
+    for (auto& node : nodes) node.staadId = jointLabels.Number(node.sapId);
+    for (auto& beam : beams) beam.staadId = frameLabels.Number(beam.sapId);
+    for (auto& cable : cables) cable.staadId = cableLabels.Number(cable.sapId);
+
+    coordinates.x.reserve(nodes.size());
+    coordinates.y.reserve(nodes.size());
+    coordinates.z.reserve(nodes.size());
+    for (const auto& node : nodes) {
+        coordinates.x.push_back(node.x);
+        coordinates.y.push_back(node.y);
+        coordinates.z.push_back(node.z);
+    }
+
+    cout << "Model arena: " << counter_.Allocations() << " heap allocation(s), "
+        << counter_.PeakBytes() / 1024 << " KB for "
+        << nodes.size() << " nodes, " << beams.size() << " beams, "
+        << cables.size() << " cables, " << restraints.size() << " restraints" << endl;
+    if (jointLabels.AlphanumericCount() + frameLabels.AlphanumericCount() + cableLabels.AlphanumericCount() > 0) {
+        cout << "Alphanumeric labels: " << jointLabels.AlphanumericCount() << " joint(s), "
+            << frameLabels.AlphanumericCount() << " frame(s), " << cableLabels.AlphanumericCount()
+            << " cable(s), numbered after the largest numeric label" << endl;
+    }
+    if (cableLabels.RenumberedCount() > 0) {
+        cout << "Cables numbered after the frames: " << cableLabels.RenumberedCount()
+            << " cable label(s) also used by a frame" << endl;
+    }
+
+    if (errors.Total() > 0) {
+        cerr << "Skipped rows with " << errors.Total() << " malformed field(s):\n";
+        errors.PrintSummary(cerr);
+    }
+}
+
+vector<uint32_t> SAP2000Model::NodeByLabel() const {
+    vector<uint32_t> byLabel(jointLabels.size(), LabelTable::kNone);
+    for (uint32_t j = 0; j < nodes.size(); ++j) {
+        uint32_t& slot = byLabel[nodes[j].sapId];
+        if (slot == LabelTable::kNone) slot = j;
+    }
+    return byLabel;
+}
+
+// Copies the coordinate arrays back into the nodes after a transform stage.
+void SAP2000Model::StoreCoordinates() {
+    for (size_t i = 0; i < nodes.size(); ++i) {
+        nodes[i].x = coordinates.x[i];
+        nodes[i].y = coordinates.y[i];
+        nodes[i].z = coordinates.z[i];
+    }
+}
+
+void SAP2000Model::Release() {
+    // The vectors must let go of their storage before the arena hands it back
+    ModelVector<Node>(&arena_).swap(nodes);
+    ModelVector<Beam>(&arena_).swap(beams);
+    ModelVector<Cable>(&arena_).swap(cables);
+    ModelVector<JointRestraint>(&arena_).swap(restraints);
+    ModelVector<JointSpring>(&arena_).swap(springs);
+    ModelVector<GroupAssignment>(&arena_).swap(groups);
+    ModelVector<FrameLocalAxis>(&arena_).swap(localAxes);
+    ModelVector<FrameInsertion>(&arena_).swap(insertions);
+    ModelVector<ComboTerm>(&arena_).swap(comboTerms);
+    patternNames.clear();
+    comboNames.clear();
+    comboKinds.clear();
+    groupNames.clear();
+    jointLabels.Clear();
+    frameLabels.Clear();
+    cableLabels.Clear();
+    ModelVector<double>(&arena_).swap(coordinates.x);
+    ModelVector<double>(&arena_).swap(coordinates.y);
+    ModelVector<double>(&arena_).swap(coordinates.z);
+    arena_.release();
+}
@@ -0,0 +1,82 @@
+#pragma once
+#include <string>
+#include <memory_resource>
+#include "SAP2000Parser.h"
+
+// Upstream resource that records what the model arena takes from the heap.
+class AllocationCounter : public std::pmr::memory_resource {
+public:
+    explicit AllocationCounter(std::pmr::memory_resource* upstream = std::pmr::new_delete_resource());
+    size_t Allocations() const { return allocations_; }
+    size_t BytesInUse() const { return bytesInUse_; }
+    size_t PeakBytes() const { return peakBytes_; }
+private:
+    void* do_allocate(size_t bytes, size_t alignment) override;
+    void do_deallocate(void* p, size_t bytes, size_t alignment) override;
+    bool do_is_equal(const std::pmr::memory_resource& other) const noexcept override;
+
+    std::pmr::memory_resource* upstream_;
+    size_t allocations_ = 0;
+    size_t bytesInUse_ = 0;
+    size_t peakBytes_ = 0;
+};
+
+// Joint coordinates as structure-of-arrays, index-aligned with `nodes`,
+// for the numeric stages that sweep the whole model.
+struct CoordinateArrays {
+    explicit CoordinateArrays(std::pmr::memory_resource* resource)
+        : x(resource), y(resource), z(resource) {
+    }
+    size_t size() const { return x.size(); }
+    ModelVector<double> x;
+    ModelVector<double> y;
+    ModelVector<double> z;
+};
+
+// Parsed SAP2000 model. Every table lives in one monotonic arena sized from the
+// row counts gathered by ParseFile, so the tables fill without reallocating and
+// the whole model is freed in a single release.
+class SAP2000Model {
+public:
+    explicit SAP2000Model(const SectionPositions& positions);
+    SAP2000Model(const SAP2000Model&) = delete;
+    SAP2000Model& operator=(const SAP2000Model&) = delete;
+
+    // Marks `text` with the table offsets before reading the tables
+    void Load(InputText& text);
+    void StoreCoordinates();
+    // Index into `nodes` for every joint label, LabelTable::kNone where the
+    // label has no coordinates. A repeated label resolves to its first row.
+    std::vector<uint32_t> NodeByLabel() const;
+    void Release();
+    std::pmr::memory_resource* Resource() { return &arena_; }
+    const AllocationCounter& Allocations() const { return counter_; }
+
+    const SectionPositions sections;
+
+private:
+    AllocationCounter counter_;
+    std::pmr::monotonic_buffer_resource arena_;
+
+public:
+    ModelVector<Node> nodes;
+    ModelVector<Beam> beams;
+    ModelVector<Cable> cables;
+    ModelVector<JointRestraint> restraints;
+    ModelVector<JointSpring> springs;
+    ModelVector<GroupAssignment> groups;
+    ModelVector<FrameLocalAxis> localAxes;
+    ModelVector<FrameInsertion> insertions;
+    ModelVector<ComboTerm> comboTerms;
+    std::vector<std::string> patternNames;
+    std::vector<std::string> comboNames;
+    std::vector<ComboKind> comboKinds;
+    std::vector<std::string> groupNames;
+    LabelTable jointLabels;
+    LabelTable frameLabels;
+    LabelTable cableLabels; // Numbered after the frames: they share the STAAD member numbering
+    CoordinateArrays coordinates;
+    UnitSystem units;
+    UpAxis upAxis = UpAxis::Z; // SAP2000 global Z is vertical
+    ParseErrorLog errors;
+};
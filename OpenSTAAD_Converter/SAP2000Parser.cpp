@@ -1,281 +1,421 @@
 ﻿#include "SAP2000Parser.h"
+#include "InputStream.h"
 #include <fstream>
 #include <sstream>
 #include <algorithm>
 #include <iostream>
 #include <regex>
+#include <charconv>
+#include <cstring>
+#include <unordered_map>
 
 using namespace std;
 
-SectionPositions SAP2000Parser::ParseFile(const string& filePath) {
-    SectionPositions positions;
-    cout << "Opening file: " << filePath << endl; // Debug the path
-    ifstream inputFile(filePath);
+namespace {
+    bool IsBlankLine(const string& line) {
+        return all_of(line.begin(), line.end(), [](unsigned char c) { return isspace(c) != 0; });
+    }
 
-    if (!inputFile.is_open()) {
-        cerr << "ERROR: Failed to open file! Path: " << filePath << endl;
+    const char* ReasonText(ParseErrorReason reason) {
+        switch (reason) {
+        case ParseErrorReason::MissingField: return "missing field";
+        case ParseErrorReason::NotANumber: return "not a number";
+        case ParseErrorReason::OutOfRange: return "out of range";
+        case ParseErrorReason::TrailingCharacters: return "trailing characters";
+        default: return "unknown";
+        }
     }
+
+    // Reads "Key=value" fields of one table row without throwing or allocating.
+    // Failures are recorded in the error log and flag the row as failed.
+    class RowReader {
+    public:
+        RowReader(const char* table, ParseErrorLog* errors)
+            : table_(table), errors_(errors) {
+        }
+
+        void Reset(const string& line, long lineNumber) {
+            line_ = &line;
+            lineNumber_ = lineNumber;
+            failed_ = false;
+        }
+
+        bool Failed() const { return failed_; }
+
+        template <typename T>
+        bool Read(const char* key, T& value, bool required = true) {
+            size_t begin, end;
+            if (!Find(key, begin, end)) {
+                if (required) Fail(key, 0, ParseErrorReason::MissingField);
+                return false;
+            }
+            const char* first = line_->data() + begin;
+            const char* last = line_->data() + end;
+            if (first != last && *first == '+') ++first;
+            T parsed{};
+            auto result = from_chars(first, last, parsed);
+            if (result.ec == errc::invalid_argument) {
+                Fail(key, begin, ParseErrorReason::NotANumber);
+                return false;
+            }
+            if (result.ec == errc::result_out_of_range) {
+                Fail(key, begin, ParseErrorReason::OutOfRange);
+                return false;
+            }
+            if (result.ptr != last) {
+                Fail(key, begin, ParseErrorReason::TrailingCharacters);
+                return false;
+            }
+            value = parsed;
+            return true;
+        }
+
+        // Plain or quoted ("Tower core") text value
+        bool ReadText(const char* key, string& value, bool required = true) {
+            string_view text;
+            if (!ReadView(key, text, required)) return false;
+            value.assign(text);
+            return true;
+        }
+
+        // Joint, frame or cable label, numeric or not, interned into `labels`
+        bool ReadLabel(const char* key, LabelTable& labels, uint32_t& value) {
+            string_view text;
+            if (!ReadView(key, text, true)) return false;
+            if (text.empty()) {
+                Fail(key, text.data() - line_->data(), ParseErrorReason::MissingField);
+                return false;
+            }
+            value = labels.Intern(text);
+            return true;
+        }
+
+        // Label of an object read from an earlier table; false when unknown
+        bool ReadKnownLabel(const char* key, const LabelTable& labels, uint32_t& value) {
+            string_view text;
+            if (!ReadView(key, text, true)) return false;
+            value = labels.Find(text);
+            return value != LabelTable::kNone;
+        }
+
+        bool ReadYesNo(const char* key) {
+            size_t begin, end;
+            if (!Find(key, begin, end)) return false;
+            return line_->compare(begin, 3, "Yes") == 0;
+        }
+
+    private:
+        bool ReadView(const char* key, string_view& value, bool required) {
+            size_t begin, end;
+            if (!Find(key, begin, end)) {
+                if (required) Fail(key, 0, ParseErrorReason::MissingField);
+                return false;
+            }
+            if (begin < line_->length() && (*line_)[begin] == '"') {
+                size_t close = line_->find('"', begin + 1);
+                end = close == string::npos ? line_->length() : close;
+                begin++;
+            }
+            value = string_view(*line_).substr(begin, end - begin);
+            return true;
+        }
+
+        bool Find(const char* key, size_t& begin, size_t& end) const {
+            size_t pos = line_->find(key);
+            if (pos == string::npos) return false;
+            begin = pos + strlen(key);
+            end = line_->find(' ', begin);
+            if (end == string::npos) end = line_->length();
+            return true;
+        }
+
+        void Fail(const char* key, size_t column, ParseErrorReason reason) {
+            failed_ = true;
+            if (errors_) errors_->Add(table_, lineNumber_, column + 1, key, reason);
+        }
+
+        const char* table_;
+        ParseErrorLog* errors_;
+        const string* line_ = nullptr;
+        long lineNumber_ = 0;
+        bool failed_ = false;
+    };
+}
+
+ParseErrorLog::ParseErrorLog(size_t capPerTable)
+    : capPerTable_(capPerTable) {
+}
+
+ParseErrorLog::TableErrors& ParseErrorLog::Table(const char* table) {
+    for (auto& entry : tables_) {
+        if (entry.table == table || strcmp(entry.table, table) == 0) return entry;
+    }
+    TableErrors entry;
+    entry.table = table;
+    tables_.push_back(std::move(entry));
+    return tables_.back();
+}
+
+void ParseErrorLog::Add(const char* table, long line, size_t column, const char* field, ParseErrorReason reason) {
+    TableErrors& errors = Table(table);
+    errors.total++;
+    errors.byReason[static_cast<size_t>(reason)]++;
+    total_++;
+    if (errors.entries.size() < capPerTable_) {
+        errors.entries.push_back(ParseError{ line, static_cast<uint32_t>(column), field, reason });
+    }
+}
+
+void ParseErrorLog::PrintSummary(ostream& out) const {
+    for (const auto& errors : tables_) {
+        out << "  " << errors.table << ": " << errors.total << " malformed field(s)";
+        for (size_t r = 0; r < static_cast<size_t>(ParseErrorReason::Count); ++r) {
+            if (errors.byReason[r] > 0) {
+                out << ", " << errors.byReason[r] << " " << ReasonText(static_cast<ParseErrorReason>(r));
+            }
+        }
+        out << "\n";
+    }
+}
+
+bool ParseErrorLog::WriteReport(const string& reportPath) const {
+    ofstream report(reportPath);
+    if (!report.is_open()) {
+        cerr << "ERROR: Failed to write parse report: " << reportPath << endl;
+        return false;
+    }
+    report << "SAP2000 parse errors: " << total_ << "\n";
+    PrintSummary(report);
+    for (const auto& errors : tables_) {
+        report << "\n[" << errors.table << "]\n";
+        for (const auto& error : errors.entries) {
+            // Keys are stored as searched (" Y=", "JointI="); print the bare name
+            string field = error.field;
+            field.erase(remove(field.begin(), field.end(), ' '), field.end());
+            if (!field.empty() && field.back() == '=') field.pop_back();
+            report << "line " << error.line << ", col " << error.column << ", "
+                << field << ": " << ReasonText(error.reason) << "\n";
+        }
+        if (errors.total > errors.entries.size()) {
+            report << "... " << errors.total - errors.entries.size() << " more not listed\n";
+        }
+    }
+    return true;
+}
+
+SectionPositions SAP2000Parser::ParseFile(const InputText& text) {
+    SectionPositions positions;
+    cout << "Opening file: " << text.Path() << endl; // Debug the path
+    auto input = text.OpenAt(1);
+    istream& inputFile = *input;
     string line;
     long lineNumber = 1;
+    uint64_t nextOffset = 0; // Decoded byte offset of the next line
+    size_t* currentRows = nullptr; // Row counter of the table being scanned
 
     while (getline(inputFile, line)) {
+        nextOffset += line.size() + 1;
+        if (line.find("TABLE:") != string::npos) {
+            positions.offsets.emplace_back(lineNumber + 1, nextOffset);
+        }
         replace(line.begin(), line.end(), ',', '.');
 
-        if (line.find("JOINT COORDINATES") != string::npos) {
+        if (line.find("PROGRAM CONTROL") != string::npos) {
+            positions.icontrol = lineNumber;
+            currentRows = nullptr;
+        }
+        else if (line.find("JOINT COORDINATES") != string::npos) {
             positions.ijoint = lineNumber;
+            currentRows = &positions.rows.joint;
         }
         else if (line.find("JOINT RESTRAINT ASSIGNMENTS") != string::npos) {
             positions.isupport = lineNumber;
+            currentRows = &positions.rows.support;
+        }
+        else if (line.find("JOINT SPRING ASSIGNMENTS 1 - UNCOUPLED") != string::npos) {
+            positions.ispring = lineNumber;
+            currentRows = &positions.rows.spring;
+        }
+        else if (line.find("GROUPS 2 - ASSIGNMENTS") != string::npos) {
+            positions.igroup = lineNumber;
+            currentRows = &positions.rows.group;
+        }
+        else if (line.find("FRAME LOCAL AXES ASSIGNMENTS 1 - TYPICAL") != string::npos) {
+            positions.ilocalaxes = lineNumber;
+            currentRows = &positions.rows.localaxes;
+        }
+        else if (line.find("FRAME INSERTION POINT ASSIGNMENTS") != string::npos) {
+            positions.iinsertion = lineNumber;
+            currentRows = &positions.rows.insertion;
+        }
+        else if (line.find("LOAD PATTERN DEFINITIONS") != string::npos) {
+            positions.ipattern = lineNumber;
+            currentRows = nullptr;
+        }
+        else if (line.find("COMBINATION DEFINITIONS") != string::npos) {
+            positions.icombination = lineNumber;
+            currentRows = &positions.rows.combination;
         }
         else if (line.find("JOINT LOADS - FORCE") != string::npos) {
             positions.iforce = lineNumber;
+            currentRows = &positions.rows.force;
         }
         else if (line.find("CONNECTIVITY - FRAME") != string::npos) {
             positions.iconnection = lineNumber;
+            currentRows = &positions.rows.connection;
         }
         else if (line.find("CONNECTIVITY - AREA") != string::npos) {
             positions.iplate = lineNumber;
+            currentRows = &positions.rows.plate;
         }
         else if (line.find("CONNECTIVITY - CABLE") != string::npos) {
             positions.icable = lineNumber;
+            currentRows = &positions.rows.cable;
         }
         else if (line.find("FRAME LOADS - POINT") != string::npos) {
             positions.iconc = lineNumber;
+            currentRows = &positions.rows.conc;
         }
         else if (line.find("FRAME LOADS - DISTRIBUTED") != string::npos) {
             positions.idistributed = lineNumber;
+            currentRows = &positions.rows.distributed;
         }
         else if (line.find("FRAME LOADS - OPEN STRUCTURE WIND") != string::npos) {
             positions.iframewind = lineNumber;
+            currentRows = &positions.rows.framewind;
         }
         else if (line.find("FRAME SECTION ASSIGNMENTS") != string::npos) {
             positions.isection = lineNumber;
+            currentRows = &positions.rows.section;
         }
         else if (line.find("AREA SECTION ASSIGNMENTS") != string::npos) {
             positions.iareasection = lineNumber;
+            currentRows = &positions.rows.areasection;
         }
         else if (line.find("AREA LOADS - UNIFORM") != string::npos) {
             positions.iareauload = lineNumber;
+            currentRows = &positions.rows.areauload;
         }
         else if (line.find("OPTIONS - COLORS - OUTPUT") != string::npos) {
             break;
         }
+        else if (currentRows) {
+            // Tables end at the first blank line, same rule the extractors use
+            if (IsBlankLine(line)) {
+                currentRows = nullptr;
+            }
+            else {
+                ++*currentRows;
+            }
+        }
         lineNumber++;
     }
     return positions;
 }
 
-vector<Node> SAP2000Parser::ExtractNodes(const string& filePath, long startLine) {
-    vector<Node> nodes;
-    ifstream inputFile(filePath);
-    if (!inputFile.is_open()) {
-        cerr << "ERROR: Failed to open file for node extraction!" << endl;
-        return nodes;
-    }
+ModelVector<Node> SAP2000Parser::ExtractNodes(const InputText& text, long startLine,
+    LabelTable& jointLabels, size_t expectedRows, pmr::memory_resource* resource, ParseErrorLog* errors) {
+    ModelVector<Node> nodes(resource);
+    RowReader row("JOINT COORDINATES", errors);
     if (startLine == 1) {
         std::cerr << "Zero nodes detected!" << std::endl;
-        return std::vector<Node>();
+        return nodes;
     }
+    auto input = text.OpenAt(startLine);
+    istream& inputFile = *input;
+    nodes.reserve(expectedRows);
     string line;
-    long currentLine = 1;
-    while (currentLine < startLine && getline(inputFile, line)) {
-        currentLine++;
-    }
+    long currentLine = startLine;
     while (getline(inputFile, line) && !line.empty()) {
         line.erase(remove(line.begin(), line.end(), '\r'), line.end());
         replace(line.begin(), line.end(), ',', '.');
         if (line.empty()) break;
-        if (std::all_of(line.begin(), line.end(), isspace)) break;
+        if (IsBlankLine(line)) break;
 
         Node node;
-        node.sapId = 0;
         node.x = node.y = node.z = 0.0;
 
-        try {
-            size_t jointPos = line.find("Joint=");
-            if (jointPos != string::npos) {
-                size_t endPos = line.find(' ', jointPos);
-                string jointVal = line.substr(jointPos + 6, endPos - (jointPos + 6));
-                node.sapId = stoi(jointVal);
-            }
-
-            // Find XorR= value (X coordinate)
-            size_t xPos = line.find("XorR=");
-            if (xPos != string::npos) {
-                size_t endPos = line.find(' ', xPos);
-                string xVal = line.substr(xPos + 5, endPos - (xPos + 5));
-                node.x = stod(xVal);
-            }
-
-            // Find Y= value
-            size_t yPos = line.find(" Y=");
-            if (yPos != string::npos) {
-                size_t endPos = line.find(' ', yPos + 3);
-                string yVal = line.substr(yPos + 3, endPos - (yPos + 3));
-                node.y = stod(yVal);
-            }
+        row.Reset(line, currentLine++);
+        row.Read("XorR=", node.x, false); // X coordinate
+        row.Read(" Y=", node.y, false);
+        row.Read(" Z=", node.z, false);
+        // Label last, so a row dropped for its coordinates leaves no label behind
+        if (!row.Failed()) row.ReadLabel("Joint=", jointLabels, node.sapId);
 
-            // Find Z= value
-            size_t zPos = line.find(" Z=");
-            if (zPos != string::npos) {
-                size_t endPos = line.find(' ', zPos + 3);
-                if (endPos == string::npos) endPos = line.length();
-                string zVal = line.substr(zPos + 3, endPos - (zPos + 3));
-                node.z = stod(zVal);
-            }
-
-            if (node.sapId != 0) {
-                nodes.push_back(node);
-            }
-        }
-        catch (const exception& e) {
-            cerr << "Error parsing node line: " << line << endl;
-            cerr << "Exception: " << e.what() << endl;
+        if (!row.Failed()) {
+            nodes.push_back(node);
         }
     }
     cout << "Extracted " << nodes.size() << " nodes starting from line " << startLine << endl;
     return nodes;
 }
-vector<Beam> SAP2000Parser::ExtractBeams(const string& filePath, long startLine,
-    const map<int, int>& nodeIdMap) {
-    vector<Beam> beams;
-    ifstream inputFile(filePath);
-
-    if (!inputFile.is_open()) {
-        cerr << "ERROR: Failed to open file for beam extraction!" << endl;
-        return beams;
-    }
-
+ModelVector<Beam> SAP2000Parser::ExtractBeams(const InputText& text, long startLine,
+    LabelTable& frameLabels, LabelTable& jointLabels, size_t expectedRows,
+    pmr::memory_resource* resource, ParseErrorLog* errors) {
+    ModelVector<Beam> beams(resource);
+    RowReader row("CONNECTIVITY - FRAME", errors);
     if (startLine == 1) {
             std::cerr << "Zero beams detected!" << std::endl;
-            return std::vector<Beam>();
+            return beams;
         }
+    auto input = text.OpenAt(startLine);
+    istream& inputFile = *input;
+    beams.reserve(expectedRows);
 
     string line;
-    long currentLine = 1;
-        
-    // Fast-forward to the start line
-    while (currentLine < startLine && getline(inputFile, line)) {
-        currentLine++;
-    }
+    long currentLine = startLine;
 
     while (getline(inputFile, line) && !line.empty() && (line.find("Frame=") != string::npos)) {
 
         line.erase(remove(line.begin(), line.end(), '\r'), line.end());
         if (line.empty()) break;
-        if (std::all_of(line.begin(), line.end(), isspace)) break;
+        if (IsBlankLine(line)) break;
 
         Beam beam;
-        beam.sapId = 0;
-        beam.startNodeId = 0;
-        beam.endNodeId = 0;
-
-
-        try {
-            size_t framePos = line.find("Frame=");
-            if (framePos != string::npos) {
-                size_t endPos = line.find(' ', framePos);
-                string frameVal = line.substr(framePos + 6, endPos - (framePos + 6));
-                beam.sapId = stoi(frameVal);
-            }
 
-            size_t jointIPos = line.find("JointI=");
-            if (jointIPos != string::npos) {
-                size_t endPos = line.find(' ', jointIPos);
-                string jointIVal = line.substr(jointIPos + 7, endPos - (jointIPos + 7));
-                beam.startNodeId = stoi(jointIVal);
-            }
-
-            size_t jointJPos = line.find("JointJ=");
-            if (jointJPos != string::npos) {
-                size_t endPos = line.find(' ', jointJPos);
-                if (endPos == string::npos) endPos = line.length();
-                string jointJVal = line.substr(jointJPos + 7, endPos - (jointJPos + 7));
-                beam.endNodeId = stoi(jointJVal);
-            }
+        row.Reset(line, currentLine++);
+        row.ReadLabel("Frame=", frameLabels, beam.sapId);
+        row.ReadLabel("JointI=", jointLabels, beam.startNodeId);
+        row.ReadLabel("JointJ=", jointLabels, beam.endNodeId);
 
-            if (beam.sapId != 0 && beam.startNodeId != 0 && beam.endNodeId != 0) {
-                if (nodeIdMap.empty() ||
-                    (nodeIdMap.count(beam.startNodeId) && nodeIdMap.count(beam.endNodeId))) {
-                    beams.push_back(beam);
-                }
-            }
-        }
-        catch (const exception& e) {
-            cerr << "Error parsing beam line: " << line << endl;
-            cerr << "Exception: " << e.what() << endl;
+        if (!row.Failed()) {
+            beams.push_back(beam);
         }
     }
     cout << "Extracted " << beams.size() << " beams starting from line " << startLine << endl;
     return beams;
 }
 
-vector<Cable> SAP2000Parser::ExtractCables(const string& filePath, long startLine,
-    const map<int, int>& nodeIdMap) {
-    vector<Cable> cables;
-    ifstream inputFile(filePath);
-
-    if (!inputFile.is_open()) {
-        cerr << "ERROR: Failed to open file for cable extraction!" << endl;
-        return cables;
-    }
-
+ModelVector<Cable> SAP2000Parser::ExtractCables(const InputText& text, long startLine,
+    LabelTable& cableLabels, LabelTable& jointLabels, size_t expectedRows,
+    pmr::memory_resource* resource, ParseErrorLog* errors) {
+    ModelVector<Cable> cables(resource);
+    RowReader row("CONNECTIVITY - CABLE", errors);
     if (startLine == 1) {
         std::cerr << "Zero cables detected!" << std::endl;
-        return std::vector<Cable>();
+        return cables;
     }
+    auto input = text.OpenAt(startLine);
+    istream& inputFile = *input;
+    cables.reserve(expectedRows);
 
     string line;
-    long currentLine = 1;
-
-    while (currentLine < startLine && getline(inputFile, line)) {
-        currentLine++;
-    }
+    long currentLine = startLine;
 
     while (getline(inputFile, line) && !line.empty()) {
         line.erase(remove(line.begin(), line.end(), '\r'), line.end());
         if (line.empty()) break;
-        if (std::all_of(line.begin(), line.end(), isspace)) break;
+        if (IsBlankLine(line)) break;
 
         Cable cable;
-        cable.sapId = 0;
-        cable.startNodeId = 0;
-        cable.endNodeId = 0;
-
-        try {
-
-            size_t framePos = line.find("Cable=");
-            if (framePos != string::npos) {
-                size_t endPos = line.find(' ', framePos);
-                string frameVal = line.substr(framePos + 6, endPos - (framePos + 6));
-                cable.sapId = stoi(frameVal);
-            }
 
-            size_t jointIPos = line.find("JointI=");
-            if (jointIPos != string::npos) {
-                size_t endPos = line.find(' ', jointIPos);
-                string jointIVal = line.substr(jointIPos + 7, endPos - (jointIPos + 7));
-                cable.startNodeId = stoi(jointIVal);
-            }
-
-            size_t jointJPos = line.find("JointJ=");
-            if (jointJPos != string::npos) {
-                size_t endPos = line.find(' ', jointJPos);
-                if (endPos == string::npos) endPos = line.length();
-                string jointJVal = line.substr(jointJPos + 7, endPos - (jointJPos + 7));
-                cable.endNodeId = stoi(jointJVal);
-            }
+        row.Reset(line, currentLine++);
+        row.ReadLabel("Cable=", cableLabels, cable.sapId);
+        row.ReadLabel("JointI=", jointLabels, cable.startNodeId);
+        row.ReadLabel("JointJ=", jointLabels, cable.endNodeId);
 
-            if (cable.sapId != 0 && cable.startNodeId != 0 && cable.endNodeId != 0) {
-                if (nodeIdMap.empty() ||
-                    (nodeIdMap.count(cable.startNodeId) && nodeIdMap.count(cable.endNodeId))) {
-                    cables.push_back(cable);
-                }
-            }
-        }
-        catch (const exception& e) {
-            cerr << "Error parsing cable line: " << line << endl;
-            cerr << "Exception: " << e.what() << endl;
+        if (!row.Failed()) {
+            cables.push_back(cable);
         }
     }
 
@@ -283,89 +423,451 @@ vector<Cable> SAP2000Parser::ExtractCables(const string& filePath, long startLin
     return cables;
 }
 
-std::vector<JointRestraint> SAP2000Parser::ExtractJointRestraints(
-    const std::string& filePath,
-    long startLine
+ModelVector<JointRestraint> SAP2000Parser::ExtractJointRestraints(
+    const InputText& text,
+    long startLine,
+    LabelTable& jointLabels,
+    size_t expectedRows,
+    std::pmr::memory_resource* resource,
+    ParseErrorLog* errors
 ) {
-    std::map<int, JointRestraint> restraintsMap;
-    std::ifstream inputFile(filePath);
-
-    if (!inputFile.is_open()) {
-        std::cerr << "ERROR: Failed to open file for restraint extraction!" << std::endl;
-        return std::vector<JointRestraint>();
-    }
-
+    ModelVector<JointRestraint> restraints(resource);
+    RowReader row("JOINT RESTRAINT ASSIGNMENTS", errors);
     if (startLine==1) {
         std::cerr << "Zero restraints detected!" << std::endl;
-        return std::vector<JointRestraint>();
+        return restraints;
     }
+    auto input = text.OpenAt(startLine);
+    std::istream& inputFile = *input;
+    restraints.reserve(expectedRows);
 
     std::string line;
-    long currentLine = 1;
-
-    // Skip to start line
-    while (currentLine < startLine && getline(inputFile, line)) {
-        currentLine++;
-    }
+    long currentLine = startLine;
 
     // Parse restraints
     while (getline(inputFile, line) && !line.empty()) {
         line.erase(remove(line.begin(), line.end(), '\r'), line.end());
-        if (line.empty() || all_of(line.begin(), line.end(), isspace)) continue;
-        if (line.empty()) break;
-        if (std::all_of(line.begin(), line.end(), isspace)) break;
+        if (IsBlankLine(line)) break; // End of the table, also for CRLF exports
 
         JointRestraint restraint = {};  // Initialize all members to zero/false
         restraint.jointId = 0;         // Explicitly initialize
         restraint.U1 = restraint.U2 = restraint.U3 = false;
         restraint.R1 = restraint.R2 = restraint.R3 = false;
 
-        try {
-            // Extract joint ID
-            size_t jointPos = line.find("Joint=");
-            if (jointPos != std::string::npos) {
-                size_t endPos = line.find(' ', jointPos);
-                if (endPos != std::string::npos) {
-                    restraint.jointId = stoi(line.substr(jointPos + 6, endPos - (jointPos + 6)));
-                }
-            }
+        row.Reset(line, currentLine++);
+        row.ReadLabel("Joint=", jointLabels, restraint.jointId);
 
-            // Only process if we got a valid joint ID
-            if (restraint.jointId > 0) {
-                // Extract restraints
-                auto parseRestraint = [&line](const std::string& field) {
-                    size_t pos = line.find(field + "=");
-                    if (pos != std::string::npos) {
-                        size_t endPos = line.find(' ', pos);
-                        std::string val = line.substr(pos + field.size() + 1, 3); // Get "Yes" or "No"
-                        return (val == "Yes");
-                    }
-                    return false;
-                    };
-
-                restraint.U1 = parseRestraint("U1");
-                restraint.U2 = parseRestraint("U2");
-                restraint.U3 = parseRestraint("U3");
-                restraint.R1 = parseRestraint("R1");
-                restraint.R2 = parseRestraint("R2");
-                restraint.R3 = parseRestraint("R3");
-
-                restraintsMap[restraint.jointId] = restraint;
-            }
-        }
-        catch (const std::exception& e) {
-            std::cerr << "Error parsing restraint line: " << line << std::endl;
-            std::cerr << "Exception: " << e.what() << std::endl;
+        // Only process if we got a valid joint label
+        if (!row.Failed()) {
+            restraint.U1 = row.ReadYesNo("U1=");
+            restraint.U2 = row.ReadYesNo("U2=");
+            restraint.U3 = row.ReadYesNo("U3=");
+            restraint.R1 = row.ReadYesNo("R1=");
+            restraint.R2 = row.ReadYesNo("R2=");
+            restraint.R3 = row.ReadYesNo("R3=");
+
+            restraints.push_back(restraint);
         }
     }
 
-    // Convert map to vector
-    std::vector<JointRestraint> restraints;
-    restraints.reserve(restraintsMap.size());
-    for (const auto& pair : restraintsMap) {
-        restraints.push_back(pair.second);
+    // Sort by joint and keep the last row of each joint, in place
+    std::stable_sort(restraints.begin(), restraints.end(),
+        [](const JointRestraint& a, const JointRestraint& b) { return a.jointId < b.jointId; });
+    auto out = restraints.begin();
+    for (auto it = restraints.begin(); it != restraints.end(); ++it) {
+        auto next = it + 1;
+        if (next != restraints.end() && next->jointId == it->jointId) continue;
+        *out++ = *it;
     }
+    restraints.erase(out, restraints.end());
 
     std::cout << "Extracted " << restraints.size() << " joint restraints\n";
     return restraints;
-}
\ No newline at end of file
+}
+
+ModelVector<JointSpring> SAP2000Parser::ExtractJointSprings(
+    const InputText& text,
+    long startLine,
+    LabelTable& jointLabels,
+    size_t expectedRows,
+    std::pmr::memory_resource* resource,
+    ParseErrorLog* errors
+) {
+    ModelVector<JointSpring> springs(resource);
+    RowReader row("JOINT SPRING ASSIGNMENTS 1 - UNCOUPLED", errors);
+    if (startLine == 1) {
+        return springs; // Springs are optional, no warning
+    }
+    auto input = text.OpenAt(startLine);
+    std::istream& inputFile = *input;
+    springs.reserve(expectedRows);
+
+    std::string line;
+    long currentLine = startLine;
+
+    while (getline(inputFile, line) && !line.empty()) {
+        line.erase(remove(line.begin(), line.end(), '\r'), line.end());
+        replace(line.begin(), line.end(), ',', '.');
+        if (IsBlankLine(line)) break;
+
+        JointSpring spring;
+
+        row.Reset(line, currentLine++);
+        row.Read("U1=", spring.U1, false);
+        row.Read("U2=", spring.U2, false);
+        row.Read("U3=", spring.U3, false);
+        row.Read("R1=", spring.R1, false);
+        row.Read("R2=", spring.R2, false);
+        row.Read("R3=", spring.R3, false);
+        if (!row.Failed()) row.ReadLabel("Joint=", jointLabels, spring.jointId);
+
+        if (!row.Failed()) {
+            springs.push_back(spring);
+        }
+    }
+
+    // Same ordering as the restraints so both tables can be merged by joint
+    std::stable_sort(springs.begin(), springs.end(),
+        [](const JointSpring& a, const JointSpring& b) { return a.jointId < b.jointId; });
+
+    std::cout << "Extracted " << springs.size() << " joint springs\n";
+    return springs;
+}
+
+ModelVector<FrameLocalAxis> SAP2000Parser::ExtractFrameLocalAxes(
+    const InputText& text,
+    long startLine,
+    const LabelTable& frameLabels,
+    size_t expectedRows,
+    std::pmr::memory_resource* resource,
+    ParseErrorLog* errors
+) {
+    ModelVector<FrameLocalAxis> axes(resource);
+    RowReader row("FRAME LOCAL AXES ASSIGNMENTS 1 - TYPICAL", errors);
+    if (startLine == 1) {
+        return axes; // Every frame keeps the default orientation
+    }
+    auto input = text.OpenAt(startLine);
+    std::istream& inputFile = *input;
+    axes.reserve(expectedRows);
+
+    std::string line;
+    long currentLine = startLine;
+
+    while (getline(inputFile, line) && !line.empty()) {
+        line.erase(remove(line.begin(), line.end(), '\r'), line.end());
+        replace(line.begin(), line.end(), ',', '.');
+        if (IsBlankLine(line)) break;
+
+        FrameLocalAxis axis;
+
+        row.Reset(line, currentLine++);
+        bool known = row.ReadKnownLabel("Frame=", frameLabels, axis.frameId);
+        row.Read("Angle=", axis.angle);
+        axis.advanced = row.ReadYesNo("AdvanceAxes=");
+
+        if (!row.Failed() && known) {
+            axes.push_back(axis);
+        }
+    }
+
+    std::stable_sort(axes.begin(), axes.end(),
+        [](const FrameLocalAxis& a, const FrameLocalAxis& b) { return a.frameId < b.frameId; });
+
+    std::cout << "Extracted " << axes.size() << " frame local axes\n";
+    return axes;
+}
+
+ModelVector<FrameInsertion> SAP2000Parser::ExtractFrameInsertions(
+    const InputText& text,
+    long startLine,
+    const LabelTable& frameLabels,
+    size_t expectedRows,
+    std::pmr::memory_resource* resource,
+    ParseErrorLog* errors
+) {
+    ModelVector<FrameInsertion> insertions(resource);
+    RowReader row("FRAME INSERTION POINT ASSIGNMENTS", errors);
+    if (startLine == 1) {
+        return insertions; // Insertion points are optional
+    }
+    auto input = text.OpenAt(startLine);
+    std::istream& inputFile = *input;
+    insertions.reserve(expectedRows);
+
+    std::string line;
+    long currentLine = startLine;
+
+    std::string cardinalPoint, coordSys;
+    while (getline(inputFile, line) && !line.empty()) {
+        line.erase(remove(line.begin(), line.end(), '\r'), line.end());
+        replace(line.begin(), line.end(), ',', '.');
+        if (IsBlankLine(line)) break;
+
+        FrameInsertion insertion;
+
+        row.Reset(line, currentLine++);
+        bool known = row.ReadKnownLabel("Frame=", frameLabels, insertion.frameId);
+        row.Read("OffsetXI=", insertion.offsetI[0], false);
+        row.Read("OffsetYI=", insertion.offsetI[1], false);
+        row.Read("OffsetZI=", insertion.offsetI[2], false);
+        row.Read("OffsetXJ=", insertion.offsetJ[0], false);
+        row.Read("OffsetYJ=", insertion.offsetJ[1], false);
+        row.Read("OffsetZJ=", insertion.offsetJ[2], false);
+        // CardinalPt="10 (Centroid)": only the leading number matters
+        if (row.ReadText("CardinalPt=", cardinalPoint)) {
+            from_chars(cardinalPoint.data(), cardinalPoint.data() + cardinalPoint.size(), insertion.cardinalPoint);
+        }
+        if (row.ReadText("CoordSys=", coordSys)) {
+            insertion.local = coordSys == "Local" || coordSys == "LOCAL";
+        }
+
+        if (!row.Failed() && known) {
+            insertions.push_back(insertion);
+        }
+    }
+
+    std::stable_sort(insertions.begin(), insertions.end(),
+        [](const FrameInsertion& a, const FrameInsertion& b) { return a.frameId < b.frameId; });
+
+    std::cout << "Extracted " << insertions.size() << " frame insertion points\n";
+    return insertions;
+}
+
+std::vector<std::string> SAP2000Parser::ExtractLoadPatterns(const InputText& text, long startLine) {
+    std::vector<std::string> names;
+    if (startLine == 1) {
+        return names; // Patterns are then named by the combinations only
+    }
+
+    auto input = text.OpenAt(startLine);
+    std::istream& inputFile = *input;
+
+    std::string line;
+    long currentLine = startLine;
+
+    RowReader row("LOAD PATTERN DEFINITIONS", nullptr);
+    std::string name;
+    while (getline(inputFile, line) && !line.empty()) {
+        line.erase(remove(line.begin(), line.end(), '\r'), line.end());
+        if (IsBlankLine(line)) break;
+        row.Reset(line, currentLine++);
+        if (row.ReadText("LoadPat=", name)) names.push_back(name);
+    }
+
+    std::cout << "Extracted " << names.size() << " load patterns\n";
+    return names;
+}
+
+ModelVector<ComboTerm> SAP2000Parser::ExtractCombinations(
+    const InputText& text,
+    long startLine,
+    std::vector<std::string>& patternNames,
+    std::vector<std::string>& comboNames,
+    std::vector<ComboKind>& comboKinds,
+    size_t expectedRows,
+    std::pmr::memory_resource* resource,
+    ParseErrorLog* errors
+) {
+    ModelVector<ComboTerm> terms(resource);
+    RowReader row("COMBINATION DEFINITIONS", errors);
+    if (startLine == 1) {
+        return terms; // Combinations are optional
+    }
+
+    auto input = text.OpenAt(startLine);
+    std::istream& inputFile = *input;
+    terms.reserve(expectedRows);
+
+    std::string line;
+    long currentLine = startLine;
+
+    // Thousands of combinations: look names up by hash, not by scanning
+    std::unordered_map<std::string, uint32_t> patternIndex, comboIndex;
+    for (uint32_t p = 0; p < patternNames.size(); ++p) patternIndex.emplace(patternNames[p], p);
+    auto intern = [](std::unordered_map<std::string, uint32_t>& index,
+        std::vector<std::string>& names, const std::string& name) {
+        auto inserted = index.emplace(name, static_cast<uint32_t>(names.size()));
+        if (inserted.second) names.push_back(name);
+        return inserted.first->second;
+    };
+
+    // Every combination is named before any row that nests it is resolved,
+    // so read all rows first and resolve nested names afterwards
+    std::vector<std::pair<size_t, std::string>> nestedNames;
+    std::string comboName, comboType, caseType, caseName;
+    while (getline(inputFile, line) && !line.empty()) {
+        line.erase(remove(line.begin(), line.end(), '\r'), line.end());
+        replace(line.begin(), line.end(), ',', '.');
+        if (IsBlankLine(line)) break;
+
+        ComboTerm term;
+
+        row.Reset(line, currentLine++);
+        row.ReadText("ComboName=", comboName);
+        row.ReadText("CaseType=", caseType);
+        row.ReadText("CaseName=", caseName);
+        row.Read("ScaleFactor=", term.factor);
+        if (row.Failed()) continue;
+
+        term.combo = intern(comboIndex, comboNames, comboName);
+        if (comboKinds.size() < comboNames.size()) comboKinds.resize(comboNames.size(), ComboKind::LinearAdd);
+        // ComboType is only on the first row of each combination
+        if (row.ReadText("ComboType=", comboType, false)) {
+            comboKinds[term.combo] =
+                comboType == "Linear Add" ? ComboKind::LinearAdd :
+                comboType == "Envelope" ? ComboKind::Envelope :
+                comboType == "Absolute Add" ? ComboKind::AbsoluteAdd :
+                comboType == "SRSS" ? ComboKind::SRSS :
+                comboType == "Range Add" ? ComboKind::RangeAdd : ComboKind::Other;
+        }
+
+        if (caseType == "Linear Static") {
+            term.kind = ComboTerm::Pattern;
+            term.target = intern(patternIndex, patternNames, caseName);
+        }
+        else if (caseType == "Response Combo") {
+            term.kind = ComboTerm::Combo;
+            nestedNames.emplace_back(terms.size(), caseName);
+        }
+        terms.push_back(term);
+    }
+
+    for (const auto& nested : nestedNames) {
+        auto it = comboIndex.find(nested.second);
+        if (it == comboIndex.end()) {
+            terms[nested.first].kind = ComboTerm::Unsupported; // Undefined combination
+        }
+        else {
+            terms[nested.first].target = it->second;
+        }
+    }
+
+    std::cout << "Extracted " << comboNames.size() << " combinations with "
+        << terms.size() << " terms\n";
+    return terms;
+}
+
+UnitSystem SAP2000Parser::ExtractUnits(const InputText& text, long startLine) {
+    UnitSystem units;
+    if (startLine == 1) {
+        std::cerr << "PROGRAM CONTROL table not found, units unknown" << std::endl;
+        return units;
+    }
+
+    auto input = text.OpenAt(startLine);
+    std::istream& inputFile = *input;
+
+    std::string line;
+    // CurrUnits="KN, m, C" -> force, length, temperature. Read before any
+    // comma-to-dot replacement, the commas are the separators here.
+    size_t pos = std::string::npos;
+    while (getline(inputFile, line) && !IsBlankLine(line)) {
+        pos = line.find("CurrUnits=\"");
+        if (pos != std::string::npos) break;
+    }
+    if (pos == std::string::npos) {
+        std::cerr << "CurrUnits not found in PROGRAM CONTROL, units unknown" << std::endl;
+        return units;
+    }
+    size_t begin = pos + 11;
+    size_t end = line.find('"', begin);
+    std::string currUnits = line.substr(begin, end == std::string::npos ? std::string::npos : end - begin);
+
+    std::vector<std::string> parts;
+    std::stringstream ss(currUnits);
+    std::string part;
+    while (getline(ss, part, ',')) {
+        part.erase(remove_if(part.begin(), part.end(), [](unsigned char c) { return isspace(c) != 0; }), part.end());
+        transform(part.begin(), part.end(), part.begin(), [](unsigned char c) { return static_cast<char>(tolower(c)); });
+        parts.push_back(part);
+    }
+    if (parts.size() < 2) {
+        std::cerr << "Unrecognized CurrUnits: " << currUnits << std::endl;
+        return units;
+    }
+
+    static const std::pair<const char*, int> forceNames[] = {
+        { "kip", 0 }, { "lb", 1 }, { "kgf", 2 }, { "tonf", 3 }, { "n", 4 }, { "kn", 5 }
+    };
+    static const std::pair<const char*, int> lengthNames[] = {
+        { "in", 0 }, { "ft", 1 }, { "cm", 3 }, { "m", 4 }, { "mm", 5 }
+    };
+    for (const auto& name : forceNames) {
+        if (parts[0] == name.first) units.forceUnit = name.second;
+    }
+    for (const auto& name : lengthNames) {
+        if (parts[1] == name.first) units.lengthUnit = name.second;
+    }
+    if (!units.IsValid()) {
+        std::cerr << "Unrecognized CurrUnits: " << currUnits << std::endl;
+        return UnitSystem();
+    }
+
+    std::cout << "Model units: " << currUnits << std::endl;
+    return units;
+}
+
+ModelVector<GroupAssignment> SAP2000Parser::ExtractGroups(
+    const InputText& text,
+    long startLine,
+    const LabelTable& jointLabels,
+    const LabelTable& frameLabels,
+    const LabelTable& cableLabels,
+    std::vector<std::string>& groupNames,
+    size_t expectedRows,
+    std::pmr::memory_resource* resource,
+    ParseErrorLog* errors
+) {
+    ModelVector<GroupAssignment> assignments(resource);
+    RowReader row("GROUPS 2 - ASSIGNMENTS", errors);
+    if (startLine == 1) {
+        return assignments; // Groups are optional
+    }
+    auto input = text.OpenAt(startLine);
+    std::istream& inputFile = *input;
+    assignments.reserve(expectedRows);
+
+    std::string line;
+    long currentLine = startLine;
+
+    std::string groupName, objectType;
+    while (getline(inputFile, line) && !line.empty()) {
+        line.erase(remove(line.begin(), line.end(), '\r'), line.end());
+        if (IsBlankLine(line)) break;
+
+        GroupAssignment assignment;
+
+        row.Reset(line, currentLine++);
+        row.ReadText("GroupName=", groupName);
+        row.ReadText("ObjectType=", objectType);
+        if (row.Failed()) continue;
+
+        if (objectType == "Joint") assignment.type = GroupObject::Joint;
+        else if (objectType == "Frame") assignment.type = GroupObject::Frame;
+        else if (objectType == "Cable") assignment.type = GroupObject::Cable;
+        else continue;
+        // Objects that were never defined cannot be selected
+        const LabelTable& labels = assignment.type == GroupObject::Joint ? jointLabels
+            : assignment.type == GroupObject::Frame ? frameLabels : cableLabels;
+        if (!row.ReadKnownLabel("ObjectLabel=", labels, assignment.label)) continue;
+
+        // Rows come grouped by name, so checking the last name is usually enough
+        if (groupNames.empty() || groupNames.back() != groupName) {
+            auto it = std::find(groupNames.begin(), groupNames.end(), groupName);
+            if (it == groupNames.end()) {
+                groupNames.push_back(groupName);
+                it = groupNames.end() - 1;
+            }
+            assignment.group = static_cast<uint32_t>(it - groupNames.begin());
+        }
+        else {
+            assignment.group = static_cast<uint32_t>(groupNames.size() - 1);
+        }
+        assignments.push_back(assignment);
+    }
+
+    std::cout << "Extracted " << assignments.size() << " group assignments in "
+        << groupNames.size() << " groups\n";
+    return assignments;
+}
@@ -1,7 +1,37 @@
 #pragma once
 #include <string>
 #include <vector>
-#include <map>
+#include <memory_resource>
+#include <cstdint>
+#include <iosfwd>
+#include "LabelTable.h"
+#include "InputStream.h"
+
+template <typename T>
+using ModelVector = std::pmr::vector<T>;
+
+// Data rows counted under each table header, used to size model storage up front.
+struct SectionRowCounts {
+    size_t joint = 0;
+    size_t cable = 0;
+    size_t connection = 0;
+    size_t plate = 0;
+    size_t force = 0;
+    size_t conc = 0;
+    size_t load = 0;
+    size_t section = 0;
+    size_t release = 0;
+    size_t support = 0;
+    size_t spring = 0;
+    size_t group = 0;
+    size_t localaxes = 0;
+    size_t insertion = 0;
+    size_t combination = 0;
+    size_t distributed = 0;
+    size_t areasection = 0;
+    size_t areauload = 0;
+    size_t framewind = 0;
+};
 
 struct SectionPositions {
     long ijoint = 0;
@@ -14,14 +44,25 @@ struct SectionPositions {
     long isection = 0;
     long irelease = 0;
     long isupport = 0;
+    long ispring = 0;
     long idistributed = 0;
     long iareasection = 0;
     long iareauload = 0;
     long iframewind = 0;
+    long icontrol = 0;
+    long igroup = 0;
+    long ilocalaxes = 0;
+    long iinsertion = 0;
+    long ipattern = 0;
+    long icombination = 0;
+    SectionRowCounts rows;
+    LineOffsets offsets; // First row of each table, for InputText::Mark
 };
 
+// SAP2000 labels are stored as indices into the model's label tables:
+// joints into jointLabels, frames into frameLabels, cables into cableLabels.
 struct Node {
-    int sapId = 0;
+    uint32_t sapId = 0;
     double x = 0.0;
     double y = 0.0;
     double z = 0.0;
@@ -29,29 +70,175 @@ struct Node {
 };
 
 struct Beam {
-    int sapId = 0;
-    int startNodeId = 0;
-    int endNodeId = 0;
+    uint32_t sapId = 0;
+    uint32_t startNodeId = 0;
+    uint32_t endNodeId = 0;
     int staadId = 0;
+    double beta = 0.0; // STAAD beta angle in degrees, set by MemberOrientation
 };
 
 struct Cable {
-    int sapId = 0;
-    int startNodeId = 0;
-    int endNodeId = 0;
+    uint32_t sapId = 0;
+    uint32_t startNodeId = 0;
+    uint32_t endNodeId = 0;
     int staadId = 0;
 };
 
 struct JointRestraint {
-    int jointId;
+    uint32_t jointId;
     bool U1, U2, U3; // Translation restraints
     bool R1, R2, R3; // Rotation restraints
 };
 
+struct JointSpring {
+    uint32_t jointId = 0;
+    double U1 = 0.0, U2 = 0.0, U3 = 0.0; // Translational stiffness
+    double R1 = 0.0, R2 = 0.0, R3 = 0.0; // Rotational stiffness
+};
+
+// One row of FRAME LOCAL AXES ASSIGNMENTS 1 - TYPICAL
+struct FrameLocalAxis {
+    uint32_t frameId = 0;
+    double angle = 0.0;    // Degrees, local 2-3 rotated about local 1
+    bool advanced = false; // Orientation comes from the advanced axes table instead
+};
+
+// One row of FRAME INSERTION POINT ASSIGNMENTS
+struct FrameInsertion {
+    uint32_t frameId = 0;
+    int cardinalPoint = 10; // 10 = centroid
+    double offsetI[3] = {}; // Joint offsets at each end
+    double offsetJ[3] = {};
+    bool local = false;     // Offsets along local 1-2-3 instead of global X-Y-Z
+};
+
+enum class ComboKind : uint8_t { LinearAdd, Envelope, AbsoluteAdd, SRSS, RangeAdd, Other };
+
+// One row of COMBINATION DEFINITIONS: combo += factor * target.
+struct ComboTerm {
+    enum Target : uint8_t { Pattern, Combo, Unsupported };
+    uint32_t combo = 0;   // Index into the combination names
+    uint32_t target = 0;  // Index into the pattern or combination names
+    Target kind = Unsupported;
+    double factor = 0.0;
+};
+
+enum class GroupObject : uint8_t { Joint, Frame, Cable, Other };
+
+// One row of GROUPS 2 - ASSIGNMENTS; `group` indexes the group name list and
+// `label` the joint or member labels, depending on `type`.
+struct GroupAssignment {
+    uint32_t group = 0;
+    GroupObject type = GroupObject::Other;
+    uint32_t label = 0;
+};
+
+// STAAD unit codes, as accepted by NewSTAADFile
+struct UnitSystem {
+    int lengthUnit = -1; // 0 Inch, 1 Feet, 3 Centimeter, 4 Meter, 5 Millimeter, 6 Decimeter, 7 Kilometer
+    int forceUnit = -1;  // 0 Kilopound, 1 Pound, 2 Kilogram, 3 Metric Ton, 4 Newton, 5 Kilo Newton, 6 Mega Newton, 7 DecaNewton
+    bool IsValid() const { return lengthUnit >= 0 && lengthUnit <= 7 && forceUnit >= 0 && forceUnit <= 7; }
+};
+
+enum class UpAxis { Y, Z };
+
+enum class ParseErrorReason : uint8_t {
+    MissingField,
+    NotANumber,
+    OutOfRange,
+    TrailingCharacters,
+    Count
+};
+
+struct ParseError {
+    long line = 0;
+    uint32_t column = 0;     // 1-based column where the field value starts
+    const char* field = "";  // Field key as searched, e.g. "JointI="
+    ParseErrorReason reason = ParseErrorReason::MissingField;
+};
+
+// Malformed fields found while extracting, grouped by table. Only the first
+// `capPerTable` rows of each table are kept; the counts cover every failure.
+class ParseErrorLog {
+public:
+    explicit ParseErrorLog(size_t capPerTable = 1000);
+    void Add(const char* table, long line, size_t column, const char* field, ParseErrorReason reason);
+    size_t Total() const { return total_; }
+    void PrintSummary(std::ostream& out) const;
+    bool WriteReport(const std::string& reportPath) const;
+private:
+    struct TableErrors {
+        const char* table;
+        size_t total = 0;
+        size_t byReason[static_cast<size_t>(ParseErrorReason::Count)] = {};
+        std::vector<ParseError> entries;
+    };
+    TableErrors& Table(const char* table);
+
+    size_t capPerTable_;
+    size_t total_ = 0;
+    std::vector<TableErrors> tables_;
+};
+
 namespace SAP2000Parser {
-    SectionPositions ParseFile(const std::string& filePath);
-    std::vector<Node> ExtractNodes(const std::string& filePath, long startLine);
-    std::vector<Beam> ExtractBeams(const std::string& filePath, long startLine, const std::map<int, int>& nodeIdMap);
-    std::vector<Cable> ExtractCables(const std::string& filePath, long startLine, const std::map<int, int>& nodeIdMap);
-    std::vector<JointRestraint> ExtractJointRestraints(const std::string& filePath, long startLine);
+    // The scan records where each table's rows start; once the InputText is
+    // marked with those offsets, every extractor seeks to its table instead
+    // of reading the file from the top.
+    SectionPositions ParseFile(const InputText& text);
+    // Object labels are interned into the given tables as they are read.
+    // Tables that only refer to existing objects (local axes, insertions,
+    // groups) look them up instead and skip rows for unknown labels.
+    ModelVector<Node> ExtractNodes(const InputText& text, long startLine,
+        LabelTable& jointLabels,
+        size_t expectedRows = 0,
+        std::pmr::memory_resource* resource = std::pmr::get_default_resource(),
+        ParseErrorLog* errors = nullptr);
+    ModelVector<Beam> ExtractBeams(const InputText& text, long startLine,
+        LabelTable& frameLabels, LabelTable& jointLabels,
+        size_t expectedRows = 0,
+        std::pmr::memory_resource* resource = std::pmr::get_default_resource(),
+        ParseErrorLog* errors = nullptr);
+    ModelVector<Cable> ExtractCables(const InputText& text, long startLine,
+        LabelTable& cableLabels, LabelTable& jointLabels,
+        size_t expectedRows = 0,
+        std::pmr::memory_resource* resource = std::pmr::get_default_resource(),
+        ParseErrorLog* errors = nullptr);
+    ModelVector<JointRestraint> ExtractJointRestraints(const InputText& text, long startLine,
+        LabelTable& jointLabels,
+        size_t expectedRows = 0,
+        std::pmr::memory_resource* resource = std::pmr::get_default_resource(),
+        ParseErrorLog* errors = nullptr);
+    ModelVector<JointSpring> ExtractJointSprings(const InputText& text, long startLine,
+        LabelTable& jointLabels,
+        size_t expectedRows = 0,
+        std::pmr::memory_resource* resource = std::pmr::get_default_resource(),
+        ParseErrorLog* errors = nullptr);
+    ModelVector<FrameLocalAxis> ExtractFrameLocalAxes(const InputText& text, long startLine,
+        const LabelTable& frameLabels,
+        size_t expectedRows = 0,
+        std::pmr::memory_resource* resource = std::pmr::get_default_resource(),
+        ParseErrorLog* errors = nullptr);
+    ModelVector<FrameInsertion> ExtractFrameInsertions(const InputText& text, long startLine,
+        const LabelTable& frameLabels,
+        size_t expectedRows = 0,
+        std::pmr::memory_resource* resource = std::pmr::get_default_resource(),
+        ParseErrorLog* errors = nullptr);
+    // Names from LOAD PATTERN DEFINITIONS, in file order
+    std::vector<std::string> ExtractLoadPatterns(const InputText& text, long startLine);
+    // Linear static cases are matched to patternNames by name (new names are
+    // appended), combinations get indices into comboNames and comboKinds.
+    ModelVector<ComboTerm> ExtractCombinations(const InputText& text, long startLine,
+        std::vector<std::string>& patternNames,
+        std::vector<std::string>& comboNames,
+        std::vector<ComboKind>& comboKinds,
+        size_t expectedRows = 0,
+        std::pmr::memory_resource* resource = std::pmr::get_default_resource(),
+        ParseErrorLog* errors = nullptr);
+    UnitSystem ExtractUnits(const InputText& text, long startLine);
+    ModelVector<GroupAssignment> ExtractGroups(const InputText& text, long startLine,
+        const LabelTable& jointLabels, const LabelTable& frameLabels,
+        const LabelTable& cableLabels, std::vector<std::string>& groupNames,
+        size_t expectedRows = 0,
+        std::pmr::memory_resource* resource = std::pmr::get_default_resource(),
+        ParseErrorLog* errors = nullptr);
 }
\ No newline at end of file
@@ -1,9 +1,14 @@
 #include "STAADWrapper.h"
 #include "SAP2000Parser.h"
+#include "SupportSpec.h"
 #include <comutil.h>
 #include <comdef.h>
 #include <iostream>
 #include <unordered_map>
+#include <array>
+#include <tuple>
+#include <algorithm>
+#include <cstring>
 #include <string>
 #include <vector>
 #import "C:\\Program Files\\Bentley\\Engineering\\STAAD.Pro CONNECT Edition\\STAAD\\STAADPro.dll" \
@@ -12,15 +17,23 @@
 using namespace std;
 using namespace OpenSTAADUI;
 
-map<int, int> STAADWrapper::nodeIdMap_;
+map<uint32_t, int> STAADWrapper::nodeIdMap_;
 
-IOpenSTAADUIPtr STAADWrapper::Initialize(const std::wstring& filePath, int lenUnit, int forceUnit) {
+IOpenSTAADUIPtr STAADWrapper::Attach() {
     IOpenSTAADUIPtr staadApp;
     try {
-        CoInitializeEx(NULL, COINIT_APARTMENTTHREADED);
         staadApp.CreateInstance(__uuidof(OpenSTAAD));
         staadApp.GetActiveObject(__uuidof(OpenSTAAD));
+    }
+    catch (_com_error& e) {
+        cerr << "STAAD Error: " << e.ErrorMessage() << endl;
+        return nullptr;
+    }
+    return staadApp;
+}
 
+bool STAADWrapper::NewFile(IOpenSTAADUIPtr staadApp, const std::wstring& filePath, int lenUnit, int forceUnit) {
+    try {
         _variant_t varFileName(filePath.c_str());
         _variant_t varLengthUnit(lenUnit);
         _variant_t varForceUnit(forceUnit);
@@ -29,25 +42,25 @@ IOpenSTAADUIPtr STAADWrapper::Initialize(const std::wstring& filePath, int lenUn
     }
     catch (_com_error& e) {
         cerr << "STAAD Error: " << e.ErrorMessage() << endl;
-        return nullptr;
+        return false;
     }
-    return staadApp;
+    return true;
 }
 
-bool STAADWrapper::CreateNodes(IOSGeometryUIPtr geometry, vector<Node>& nodes) {
+bool STAADWrapper::CreateNodes(IOSGeometryUIPtr geometry, ModelVector<Node>& nodes) {
+    // One map per model; a long-running session converts many
+    nodeIdMap_.clear();
     try {
         for (auto& node : nodes) {
-            _variant_t varX, varY, varZ, varSapId;
+            _variant_t varX, varY, varZ, varStaadId;
             varX.vt = VT_R8; varX.dblVal = node.x;
             varY.vt = VT_R8; varY.dblVal = node.y;
             varZ.vt = VT_R8; varZ.dblVal = node.z;
-            varSapId.vt = VT_I4; varSapId.lVal = node.sapId;
-            geometry->CreateNode(varSapId, varX, varY, varZ);
-            VARIANT result = geometry->GetNodeUniqueID(varSapId);
-            if (result.vt == VT_BSTR && result.bstrVal != NULL && SysStringLen(result.bstrVal) > 0) {
-                node.staadId = varSapId;
-                nodeIdMap_[node.sapId] = node.staadId;
-            }
+            varStaadId.vt = VT_I4; varStaadId.lVal = node.staadId;
+            // Checked afterwards in bulk by ModelVerifier, not per node
+            geometry->CreateNode(varStaadId, varX, varY, varZ);
+            node.staadId = varStaadId.lVal;
+            nodeIdMap_.emplace(node.sapId, node.staadId);
         }
         return true;
     }
@@ -56,19 +69,16 @@ bool STAADWrapper::CreateNodes(IOSGeometryUIPtr geometry, vector<Node>& nodes) {
         return false;
     }
 }
-bool STAADWrapper::CreateBeams(IOSGeometryUIPtr geometry, vector<Beam>& beams, const map<int, int>& nodeIdMap) {
+bool STAADWrapper::CreateBeams(IOSGeometryUIPtr geometry, ModelVector<Beam>& beams, const map<uint32_t, int>& nodeIdMap) {
     try {
         for (size_t i = 0; i < beams.size(); ++i) {  // Use index to track position
             auto& beam = beams[i];
-            _variant_t varStart, varEnd, varSapId;
+            _variant_t varStart, varEnd, varStaadId;
             varStart.vt = VT_I4; varStart.lVal = nodeIdMap.at(beam.startNodeId);
             varEnd.vt = VT_I4; varEnd.lVal = nodeIdMap.at(beam.endNodeId);
-            varSapId.vt = VT_I4; varSapId.lVal = beam.sapId;
-            geometry->CreateBeam(varSapId, varStart, varEnd);
-            VARIANT result = geometry->GetMemberUniqueID(varSapId);
-            if (result.vt == VT_BSTR && result.bstrVal != NULL && SysStringLen(result.bstrVal) > 0) {
-                beam.staadId = varSapId;
-            }
+            varStaadId.vt = VT_I4; varStaadId.lVal = beam.staadId;
+            geometry->CreateBeam(varStaadId, varStart, varEnd);
+            beam.staadId = varStaadId.lVal;
         }
         return true;
     }
@@ -79,19 +89,16 @@ bool STAADWrapper::CreateBeams(IOSGeometryUIPtr geometry, vector<Beam>& beams, c
 }
 
 bool STAADWrapper::CreateCables(IOSGeometryUIPtr geometry,
-    vector<Cable>& cables,
-    const map<int, int>& nodeIdMap) {
+    ModelVector<Cable>& cables,
+    const map<uint32_t, int>& nodeIdMap) {
     try {
         for (auto& cable : cables) {
-            _variant_t varStart, varEnd, varSapId;
+            _variant_t varStart, varEnd, varStaadId;
             varStart.vt = VT_I4; varStart.lVal = nodeIdMap.at(cable.startNodeId);
             varEnd.vt = VT_I4; varEnd.lVal = nodeIdMap.at(cable.endNodeId);
-            varSapId.vt = VT_I4; varSapId.lVal = nodeIdMap.at(cable.sapId);
-            geometry->CreateBeam(varSapId, varStart, varEnd);
-            VARIANT result = geometry->GetMemberUniqueID(varSapId);
-            if (result.vt == VT_BSTR && result.bstrVal != NULL && SysStringLen(result.bstrVal) > 0) {
-                cable.staadId = varSapId;
-            }
+            varStaadId.vt = VT_I4; varStaadId.lVal = cable.staadId;
+            geometry->CreateBeam(varStaadId, varStart, varEnd);
+            cable.staadId = varStaadId.lVal;
         }
         return true;
     }
@@ -101,14 +108,97 @@ bool STAADWrapper::CreateCables(IOSGeometryUIPtr geometry,
     }
 }
 
-const map<int, int>& STAADWrapper::GetNodeMap() {
+const map<uint32_t, int>& STAADWrapper::GetNodeMap() {
     return nodeIdMap_;
 }
 
+namespace {
+    // Spring supports are grouped by DOF key and stiffness values
+    typedef std::pair<uint8_t, std::array<double, 6>> SpringKey;
+
+    _variant_t MakeArrayVariant(const double* values, size_t count) {
+        SAFEARRAY* psa = SafeArrayCreateVector(VT_R8, 0, static_cast<ULONG>(count));
+        if (!psa) throw std::bad_alloc();
+        double* data = nullptr;
+        SafeArrayAccessData(psa, (void**)&data);
+        memcpy(data, values, sizeof(double) * count);
+        SafeArrayUnaccessData(psa);
+
+        _variant_t var;
+        var.vt = VT_ARRAY | VT_R8;
+        var.parray = psa; // Owned and destroyed by the variant
+        return var;
+    }
+
+    _variant_t MakeArrayVariant(const std::vector<long>& values) {
+        SAFEARRAY* psa = SafeArrayCreateVector(VT_I4, 0, static_cast<ULONG>(values.size()));
+        if (!psa) throw std::bad_alloc();
+        long* data = nullptr;
+        SafeArrayAccessData(psa, (void**)&data);
+        memcpy(data, values.data(), sizeof(long) * values.size());
+        SafeArrayUnaccessData(psa);
+
+        _variant_t var;
+        var.vt = VT_ARRAY | VT_I4;
+        var.parray = psa;
+        return var;
+    }
+
+    // OpenSTAAD reports failure as -1 or as a false boolean, depending on the call
+    bool Rejected(const _variant_t& result) {
+        return (result.vt == VT_I4 && result.lVal == -1) || (result.vt == VT_BOOL && !result.boolVal);
+    }
+
+    // The support the file backend writes for the same key and springs:
+    // FIXED BUT releases the DOFs that are neither restrained nor sprung
+    _variant_t CreateSupportDefinition(OpenSTAADUI::IOSSupportUIPtr Supports,
+        uint8_t key, const double* stiffness) {
+        double released[6];
+        _variant_t supportId;
+        switch (SupportSpec::Describe(key, stiffness, released)) {
+        case SupportSpec::Kind::Fixed:
+            supportId = Supports->CreateSupportFixed();
+            break;
+        case SupportSpec::Kind::Pinned:
+            supportId = Supports->CreateSupportPinned();
+            break;
+        default: {
+            _variant_t varReleaseSpec = MakeArrayVariant(released, 6);
+            _variant_t varSpringSpec = MakeArrayVariant(stiffness, 6);
+            supportId = Supports->CreateSupportFixedBut(varReleaseSpec, varSpringSpec);
+            break;
+        }
+        }
+
+        if (Rejected(supportId)) {
+            throw _com_error(E_FAIL);
+        }
+        return supportId;
+    }
+
+    // Assigns one support to a whole node list in a single call, falling back
+    // to one call per node if STAAD rejects the array form.
+    void AssignSupportToNodes(OpenSTAADUI::IOSSupportUIPtr Supports,
+        const std::vector<long>& nodeIds, const _variant_t& supportId) {
+        _variant_t varNodeIds = MakeArrayVariant(nodeIds);
+        _variant_t result = Supports->AssignSupportToNode(varNodeIds, supportId);
+        if (!Rejected(result)) return;
+
+        for (long staadId : nodeIds) {
+            _variant_t varNodeId(staadId);
+            result = Supports->AssignSupportToNode(varNodeId, supportId);
+            if (Rejected(result)) {
+                std::cerr << "Failed to assign support to node " << staadId << std::endl;
+            }
+        }
+    }
+}
+
 bool STAADWrapper::CreateSupports(
     OpenSTAADUI::IOSSupportUIPtr Supports,
-    const std::vector<JointRestraint>& restraints,
-    const std::map<int, int>& nodeIdMap)
+    const ModelVector<JointRestraint>& restraints,
+    const ModelVector<JointSpring>& springs,
+    const std::map<uint32_t, int>& nodeIdMap)
 {
     if (!Supports) {
         std::cerr << "Invalid COM Supports object" << std::endl;
@@ -116,107 +206,55 @@ bool STAADWrapper::CreateSupports(
     }
 
     try {
-        std::map<std::tuple<bool, bool, bool, bool, bool, bool>, _variant_t> supportDefinitions;
+        // Single grouping pass over restraints and springs, both sorted by joint
+        std::array<std::vector<long>, 64> nodesByKey;
+        std::map<SpringKey, std::vector<long>> nodesBySpring;
 
-        for (const auto& restraint : restraints) {
-            if (!nodeIdMap.count(restraint.jointId)) {
-                std::cerr << "Warning: Joint " << restraint.jointId << " not found in node map" << std::endl;
-                continue;
+        auto r = restraints.begin();
+        auto s = springs.begin();
+        while (r != restraints.end() || s != springs.end()) {
+            uint32_t jointId;
+            uint8_t key = 0;
+            const JointSpring* spring = nullptr;
+
+            if (s == springs.end() || (r != restraints.end() && r->jointId < s->jointId)) {
+                jointId = r->jointId;
+                key = SupportSpec::DofKey(*r++);
+            }
+            else {
+                jointId = s->jointId;
+                if (r != restraints.end() && r->jointId == jointId) key = SupportSpec::DofKey(*r++);
+                spring = &*s++;
             }
 
-            int staadId = nodeIdMap.at(restraint.jointId);
-            auto restraintKey = std::make_tuple(
-                restraint.U1, restraint.U2, restraint.U3,
-                restraint.R1, restraint.R2, restraint.R3
-            );
-
-            // Create or reuse support definition
-            if (supportDefinitions.find(restraintKey) == supportDefinitions.end()) {
-                SAFEARRAY* psaRelease = nullptr;
-                SAFEARRAY* psaSpring = nullptr;
-                bool releaseAccessed = false;
-                bool springAccessed = false;
-
-                try {
-                    // Create and initialize SAFEARRAYs
-                    psaRelease = SafeArrayCreateVector(VT_R8, 0, 6);
-                    psaSpring = SafeArrayCreateVector(VT_R8, 0, 6);
-                    if (!psaRelease || !psaSpring) throw std::bad_alloc();
-
-                    // Access and populate data
-                    double* pReleaseData = nullptr;
-                    double* pSpringData = nullptr;
-                    SafeArrayAccessData(psaRelease, (void**)&pReleaseData);
-                    releaseAccessed = true;
-                    SafeArrayAccessData(psaSpring, (void**)&pSpringData);
-                    springAccessed = true;
-
-                    // Initialize release data
-                    pReleaseData[0] = restraint.U1 ? 1.0 : 0.0;
-                    pReleaseData[1] = restraint.U2 ? 1.0 : 0.0;
-                    pReleaseData[2] = restraint.U3 ? 1.0 : 0.0;
-                    pReleaseData[3] = restraint.R1 ? 1.0 : 0.0;
-                    pReleaseData[4] = restraint.R2 ? 1.0 : 0.0;
-                    pReleaseData[5] = restraint.R3 ? 1.0 : 0.0;
-
-                    // Initialize spring data
-                    memset(pSpringData, 0, sizeof(double) * 6);
-
-                    // Unaccess data
-                    SafeArrayUnaccessData(psaRelease);
-                    releaseAccessed = false;
-                    SafeArrayUnaccessData(psaSpring);
-                    springAccessed = false;
-
-                    // Create variants
-                    _variant_t varReleaseSpec;
-                    varReleaseSpec.vt = VT_ARRAY | VT_R8;
-                    varReleaseSpec.parray = psaRelease;
-
-                    _variant_t varSpringSpec;
-                    varSpringSpec.vt = VT_ARRAY | VT_R8;
-                    varSpringSpec.parray = psaSpring;
-
-                    // Determine support type
-                    bool allFixed = restraint.U1 && restraint.U2 && restraint.U3 &&
-                        restraint.R1 && restraint.R2 && restraint.R3;
-
-                    _variant_t supportId;
-                    if (allFixed) {
-                        supportId = Supports->CreateSupportFixed();
-                    }
-                    else {
-                        supportId = Supports->CreateSupportFixedBut(varReleaseSpec, varSpringSpec);
-                    }
-
-                    if (supportId.vt == VT_I4 && supportId.lVal == -1) {
-                        throw _com_error(E_FAIL);
-                    }
-
-                    // Store the support definition
-                    supportDefinitions[restraintKey] = supportId;
-
-                    // Release ownership to the variant
-                    psaRelease = nullptr;
-                    psaSpring = nullptr;
-                }
-                catch (...) {
-                    // Cleanup in reverse order of creation
-                    if (springAccessed) SafeArrayUnaccessData(psaSpring);
-                    if (releaseAccessed) SafeArrayUnaccessData(psaRelease);
-                    if (psaSpring) SafeArrayDestroy(psaSpring);
-                    if (psaRelease) SafeArrayDestroy(psaRelease);
-                    throw;
-                }
+            auto staad = nodeIdMap.find(jointId);
+            if (staad == nodeIdMap.end()) {
+                std::cerr << "Warning: Joint label #" << jointId << " not found in node map" << std::endl;
+                continue;
             }
 
-            // Assign support to node
-            _variant_t varNodeId(staadId);
-            _variant_t result = Supports->AssignSupportToNode(varNodeId, supportDefinitions[restraintKey]);
-            if (result.vt == VT_I4 && result.lVal == -1) {
-                std::cerr << "Failed to assign support to node " << staadId << std::endl;
+            if (spring) {
+                SpringKey springKey(key, { spring->U1, spring->U2, spring->U3,
+                    spring->R1, spring->R2, spring->R3 });
+                nodesBySpring[springKey].push_back(staad->second);
+            }
+            else {
+                nodesByKey[key].push_back(staad->second);
             }
         }
+
+        // Key 0 restrains nothing: no support, as in the file backend
+        const double noSpring[6] = {};
+        for (uint8_t key = 1; key < nodesByKey.size(); ++key) {
+            if (nodesByKey[key].empty()) continue;
+            _variant_t supportId = CreateSupportDefinition(Supports, key, noSpring);
+            AssignSupportToNodes(Supports, nodesByKey[key], supportId);
+        }
+
+        for (const auto& group : nodesBySpring) {
+            _variant_t supportId = CreateSupportDefinition(Supports, group.first.first, group.first.second.data());
+            AssignSupportToNodes(Supports, group.second, supportId);
+        }
         return true;
     }
     catch (_com_error& e) {
@@ -231,4 +269,142 @@ bool STAADWrapper::CreateSupports(
         std::cerr << "Unknown error in CreateSupports" << std::endl;
         return false;
     }
-}
\ No newline at end of file
+}
+
+bool STAADWrapper::AssignBetaAngles(IOSPropertyUIPtr property, const ModelVector<Beam>& beams) {
+    if (!property) {
+        cerr << "Invalid COM Property object" << endl;
+        return false;
+    }
+
+    try {
+        // One call per distinct angle; beta 0 is STAAD's default
+        map<double, vector<long>> membersByBeta;
+        for (const auto& beam : beams) {
+            if (beam.beta == 0.0) continue;
+            membersByBeta[beam.beta].push_back(beam.staadId);
+        }
+
+        for (const auto& group : membersByBeta) {
+            _variant_t varBeta(group.first);
+            _variant_t varMembers = MakeArrayVariant(group.second);
+            if (!Rejected(property->AssignBetaAngle(varMembers, varBeta))) continue;
+
+            for (long staadId : group.second) {
+                _variant_t varMember(staadId);
+                if (Rejected(property->AssignBetaAngle(varMember, varBeta))) {
+                    cerr << "Failed to assign beta angle to member " << staadId << endl;
+                }
+            }
+        }
+        return true;
+    }
+    catch (_com_error& e) {
+        cerr << "COM Error in AssignBetaAngles: " << e.ErrorMessage() << endl;
+        return false;
+    }
+}
+
+bool STAADWrapper::AssignMemberOffsets(IOSPropertyUIPtr property,
+    const ModelVector<FrameInsertion>& insertions,
+    const ModelVector<Beam>& beams) {
+    if (!property) {
+        cerr << "Invalid COM Property object" << endl;
+        return false;
+    }
+
+    try {
+        // One offset spec per distinct (end, axes, vector). SAP local 1-2-3
+        // map to STAAD local x-y-z once the beta angles are assigned.
+        typedef tuple<long, long, double, double, double> OffsetKey;
+        map<OffsetKey, vector<long>> membersByOffset;
+        for (const auto& beam : beams) {
+            auto it = lower_bound(insertions.begin(), insertions.end(), beam.sapId,
+                [](const FrameInsertion& a, uint32_t id) { return a.frameId < id; });
+            if (it == insertions.end() || it->frameId != beam.sapId) continue;
+
+            long staadId = beam.staadId;
+            for (long end = 0; end < 2; ++end) {
+                const double* offset = end == 0 ? it->offsetI : it->offsetJ;
+                if (offset[0] == 0.0 && offset[1] == 0.0 && offset[2] == 0.0) continue;
+                OffsetKey key(end, it->local ? 1 : 0, offset[0], offset[1], offset[2]);
+                membersByOffset[key].push_back(staadId);
+            }
+        }
+
+        for (const auto& group : membersByOffset) {
+            _variant_t varEnd(get<0>(group.first));
+            _variant_t varLocal(get<1>(group.first));
+            _variant_t varX(get<2>(group.first)), varY(get<3>(group.first)), varZ(get<4>(group.first));
+            _variant_t specId = property->CreateMemberOffsetSpec(varEnd, varLocal, varX, varY, varZ);
+            if (Rejected(specId)) {
+                cerr << "Failed to create member offset spec" << endl;
+                continue;
+            }
+
+            _variant_t varMembers = MakeArrayVariant(group.second);
+            if (!Rejected(property->AssignMemberSpecToBeam(varMembers, specId))) continue;
+
+            for (long staadId : group.second) {
+                _variant_t varMember(staadId);
+                if (Rejected(property->AssignMemberSpecToBeam(varMember, specId))) {
+                    cerr << "Failed to assign member offset to member " << staadId << endl;
+                }
+            }
+        }
+        return true;
+    }
+    catch (_com_error& e) {
+        cerr << "COM Error in AssignMemberOffsets: " << e.ErrorMessage() << endl;
+        return false;
+    }
+}
+
+bool STAADWrapper::CreateLoadCombinations(IOSLoadUIPtr load,
+    const vector<string>& patternNames,
+    const vector<string>& comboNames,
+    const CombinationMatrix& combinations) {
+    if (combinations.Rows() == 0) return true;
+    if (!load) {
+        cerr << "Invalid COM Load object" << endl;
+        return false;
+    }
+
+    try {
+        // One primary load per pattern, in pattern order, so STAAD load
+        // numbers follow the SAP pattern list
+        vector<long> loadNumber(patternNames.size(), 0);
+        for (size_t p = 0; p < patternNames.size(); ++p) {
+            _variant_t varTitle(patternNames[p].c_str());
+            _variant_t result = load->CreateNewPrimaryLoad(varTitle);
+            if (Rejected(result)) {
+                cerr << "Failed to create primary load " << patternNames[p] << endl;
+                continue;
+            }
+            loadNumber[p] = result.vt == VT_I4 ? result.lVal : static_cast<long>(p + 1);
+        }
+
+        // Combinations start at the next hundred after the primary loads
+        const long firstNumber = LoadCombinations::FirstLoadNumber(patternNames.size());
+        for (size_t r = 0; r < combinations.Rows(); ++r) {
+            _variant_t varTitle(comboNames[combinations.combos[r]].c_str());
+            _variant_t varNumber(static_cast<long>(firstNumber + r));
+            if (Rejected(load->CreateNewLoadCombination(varTitle, varNumber))) {
+                cerr << "Failed to create load combination " << comboNames[combinations.combos[r]] << endl;
+                continue;
+            }
+            for (uint32_t e = combinations.offsets[r]; e < combinations.offsets[r + 1]; ++e) {
+                long primary = loadNumber[combinations.patterns[e]];
+                if (primary == 0) continue;
+                _variant_t varLoad(primary);
+                _variant_t varFactor(combinations.factors[e]);
+                load->AddLoadAndFactorToCombination(varNumber, varLoad, varFactor);
+            }
+        }
+        return true;
+    }
+    catch (_com_error& e) {
+        cerr << "COM Error in CreateLoadCombinations: " << e.ErrorMessage() << endl;
+        return false;
+    }
+}
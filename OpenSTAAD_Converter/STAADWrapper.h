@@ -3,27 +3,40 @@
 #include <vector>
 #include <map>
 #include "SAP2000Parser.h"
+#include "LoadCombinations.h"
 
 #import "C:\\Program Files\\Bentley\\Engineering\\STAAD.Pro CONNECT Edition\\STAAD\\STAADPro.dll" \
     named_guids
 
 class STAADWrapper {
 public:
-    static OpenSTAADUI::IOpenSTAADUIPtr Initialize(const std::wstring& filePath, int lenUnit, int forceUnit);
-    static bool CreateNodes(OpenSTAADUI::IOSGeometryUIPtr geometry, std::vector<Node>& nodes);
+    // Attaches to the running STAAD.Pro; COM must already be initialized
+    static OpenSTAADUI::IOpenSTAADUIPtr Attach();
+    static bool NewFile(OpenSTAADUI::IOpenSTAADUIPtr staadApp, const std::wstring& filePath, int lenUnit, int forceUnit);
+    static bool CreateNodes(OpenSTAADUI::IOSGeometryUIPtr geometry, ModelVector<Node>& nodes);
     static bool CreateBeams(OpenSTAADUI::IOSGeometryUIPtr geometry,
-        std::vector<Beam>& beams,
-        const std::map<int, int>& nodeIdMap);
+        ModelVector<Beam>& beams,
+        const std::map<uint32_t, int>& nodeIdMap);
     static bool CreateCables(OpenSTAADUI::IOSGeometryUIPtr geometry,
-        std::vector<Cable>& cables,
-        const std::map<int, int>& nodeIdMap);
-    static const std::map<int, int>& GetNodeMap();
+        ModelVector<Cable>& cables,
+        const std::map<uint32_t, int>& nodeIdMap);
+    static const std::map<uint32_t, int>& GetNodeMap();
     static bool STAADWrapper::CreateSupports(
         OpenSTAADUI::IOSSupportUIPtr Supports,
-        const std::vector<JointRestraint>& restraints,
-        const std::map<int, int>& nodeIdMap);
+        const ModelVector<JointRestraint>& restraints,
+        const ModelVector<JointSpring>& springs,
+        const std::map<uint32_t, int>& nodeIdMap);
+    static bool AssignBetaAngles(OpenSTAADUI::IOSPropertyUIPtr property,
+        const ModelVector<Beam>& beams);
+    static bool AssignMemberOffsets(OpenSTAADUI::IOSPropertyUIPtr property,
+        const ModelVector<FrameInsertion>& insertions,
+        const ModelVector<Beam>& beams);
+    static bool CreateLoadCombinations(OpenSTAADUI::IOSLoadUIPtr load,
+        const std::vector<std::string>& patternNames,
+        const std::vector<std::string>& comboNames,
+        const CombinationMatrix& combinations);
 private:
-    static std::map<int, int> nodeIdMap_;
+    static std::map<uint32_t, int> nodeIdMap_;
 };
 
 
@@ -0,0 +1,76 @@
+#include "SpatialIndex.h"
+#include <algorithm>
+
+using namespace std;
+
+namespace {
+    const uint32_t kLeafSize = 8;
+}
+
+void BoundingVolumeHierarchy::Build(vector<BoundingBox> boxes) {
+    boxes_ = move(boxes);
+    order_.resize(boxes_.size());
+    for (uint32_t i = 0; i < order_.size(); ++i) order_[i] = i;
+    nodes_.clear();
+    nodes_.reserve(2 * (boxes_.size() / kLeafSize + 1));
+    if (!boxes_.empty()) BuildNode(0, static_cast<uint32_t>(boxes_.size()));
+}
+
+uint32_t BoundingVolumeHierarchy::BuildNode(uint32_t begin, uint32_t end) {
+    uint32_t index = static_cast<uint32_t>(nodes_.size());
+    nodes_.emplace_back();
+
+    BoundingBox bounds = boxes_[order_[begin]];
+    for (uint32_t i = begin + 1; i < end; ++i) {
+        const BoundingBox& box = boxes_[order_[i]];
+        for (int a = 0; a < 3; ++a) {
+            bounds.min[a] = min(bounds.min[a], box.min[a]);
+            bounds.max[a] = max(bounds.max[a], box.max[a]);
+        }
+    }
+    nodes_[index].bounds = bounds;
+
+    if (end - begin <= kLeafSize) {
+        nodes_[index].first = begin;
+        nodes_[index].count = end - begin;
+        return index;
+    }
+
+    int axis = 0;
+    for (int a = 1; a < 3; ++a) {
+        if (bounds.max[a] - bounds.min[a] > bounds.max[axis] - bounds.min[axis]) axis = a;
+    }
+    uint32_t middle = begin + (end - begin) / 2;
+    nth_element(order_.begin() + begin, order_.begin() + middle, order_.begin() + end,
+        [&](uint32_t a, uint32_t b) {
+            return boxes_[a].min[axis] + boxes_[a].max[axis] < boxes_[b].min[axis] + boxes_[b].max[axis];
+        });
+
+    // Left child always directly follows its parent
+    BuildNode(begin, middle);
+    uint32_t right = BuildNode(middle, end);
+    nodes_[index].first = right;
+    nodes_[index].count = 0;
+    return index;
+}
+
+void BoundingVolumeHierarchy::Query(const BoundingBox& region, vector<uint32_t>& hits) const {
+    if (nodes_.empty()) return;
+    uint32_t stack[64];
+    int top = 0;
+    stack[top++] = 0;
+    while (top > 0) {
+        const Node& node = nodes_[stack[--top]];
+        if (!node.bounds.Overlaps(region)) continue;
+        if (node.count > 0) {
+            for (uint32_t i = node.first; i < node.first + node.count; ++i) {
+                if (boxes_[order_[i]].Overlaps(region)) hits.push_back(order_[i]);
+            }
+        }
+        else {
+            uint32_t self = static_cast<uint32_t>(&node - nodes_.data());
+            stack[top++] = node.first;  // Right child
+            stack[top++] = self + 1;    // Left child
+        }
+    }
+}
@@ -0,0 +1,41 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+struct BoundingBox {
+    double min[3] = { 0.0, 0.0, 0.0 };
+    double max[3] = { 0.0, 0.0, 0.0 };
+
+    bool Overlaps(const BoundingBox& other) const {
+        for (int a = 0; a < 3; ++a) {
+            if (max[a] < other.min[a] || min[a] > other.max[a]) return false;
+        }
+        return true;
+    }
+    bool Contains(double x, double y, double z) const {
+        return x >= min[0] && x <= max[0] && y >= min[1] && y <= max[1] && z >= min[2] && z <= max[2];
+    }
+};
+
+// Static bounding volume hierarchy over axis-aligned boxes (degenerate boxes
+// for joints, segment bounds for members). Built once by median splits on
+// the longest axis; queries return primitive indices in no particular order.
+class BoundingVolumeHierarchy {
+public:
+    void Build(std::vector<BoundingBox> boxes);
+    void Query(const BoundingBox& region, std::vector<uint32_t>& hits) const;
+    size_t size() const { return boxes_.size(); }
+
+private:
+    struct Node {
+        BoundingBox bounds;
+        uint32_t first = 0;  // Leaf: first primitive in order_; inner: left child
+        uint32_t count = 0;  // Leaf: primitive count; inner: 0
+    };
+    uint32_t BuildNode(uint32_t begin, uint32_t end);
+
+    std::vector<BoundingBox> boxes_;
+    std::vector<uint32_t> order_;
+    std::vector<Node> nodes_;
+};
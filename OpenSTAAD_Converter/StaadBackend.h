@@ -0,0 +1,33 @@
+#pragma once
+#include <string>
+#include <vector>
+#include "SAP2000Model.h"
+#include "LoadCombinations.h"
+
+// Destination of a conversion. The COM backend drives a running STAAD.Pro;
+// the file backend writes the .std input file itself, so conversions also run
+// where STAAD.Pro is not installed. Paths are UTF-8.
+class StaadBackend {
+public:
+    virtual ~StaadBackend() = default;
+    virtual const char* Name() const = 0;
+    // Once per process; the service keeps the session open between jobs
+    virtual bool Open() = 0;
+    // Whether NewModel can set up a model with this vertical axis
+    virtual bool SupportsUpAxis(UpAxis up) const = 0;
+    // Starts an empty model that Save writes to stdPath
+    virtual bool NewModel(const std::string& stdPath, const UnitSystem& units, UpAxis up) = 0;
+    // Fills Node::staadId and Beam/Cable::staadId with the numbers used
+    virtual bool CreateNodes(ModelVector<Node>& nodes) = 0;
+    virtual bool CreateBeams(ModelVector<Beam>& beams) = 0;
+    virtual bool CreateCables(ModelVector<Cable>& cables) = 0;
+    virtual bool CreateSupports(const ModelVector<JointRestraint>& restraints,
+        const ModelVector<JointSpring>& springs) = 0;
+    virtual bool AssignBetaAngles(const ModelVector<Beam>& beams) = 0;
+    virtual bool AssignMemberOffsets(const ModelVector<FrameInsertion>& insertions,
+        const ModelVector<Beam>& beams) = 0;
+    virtual bool CreateLoadCombinations(const std::vector<std::string>& patternNames,
+        const std::vector<std::string>& comboNames,
+        const CombinationMatrix& combinations) = 0;
+    virtual bool Save() = 0;
+};
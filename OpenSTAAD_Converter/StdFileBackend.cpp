@@ -0,0 +1,330 @@
+#include "StdFileBackend.h"
+#include "SupportSpec.h"
+#include <algorithm>
+#include <array>
+#include <charconv>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <map>
+#include <tuple>
+
+using namespace std;
+
+namespace {
+    const size_t kInputWidth = 79;
+
+    const char* kLengthNames[8] = { "INCHES", "FEET", "FEET", "CM", "METER", "MMS", "DME", "KM" };
+    const char* kForceNames[8] = { "KIP", "POUND", "KG", "MTON", "NEWTON", "KN", "MNS", "DNS" };
+    const char* kDofNames[6] = { "FX", "FY", "FZ", "MX", "MY", "MZ" };
+
+    // Shortest text that reads back to the same double
+    void AppendNumber(string& out, double value) {
+        if (value == 0.0) value = 0.0; // No "-0"
+        char buffer[32];
+        auto result = to_chars(buffer, buffer + sizeof(buffer), value);
+        out.append(buffer, result.ptr);
+    }
+
+    string NumberText(double value) {
+        string text;
+        AppendNumber(text, value);
+        return text;
+    }
+
+    // One STAAD command line, wrapped at the input width with the trailing
+    // '-' continuation
+    void AppendTokens(string& out, const vector<string>& tokens) {
+        string line;
+        for (const auto& token : tokens) {
+            if (!line.empty() && line.size() + token.size() + 3 > kInputWidth) {
+                out += line;
+                out += " -\n";
+                line.clear();
+            }
+            if (!line.empty()) line += ' ';
+            line += token;
+        }
+        out += line;
+        out += '\n';
+    }
+
+    // "<before> 1 TO 4 7 9 <after>", runs of three or more collapsed
+    void AppendList(string& out, const string& before, vector<long> ids, const string& after) {
+        sort(ids.begin(), ids.end());
+        ids.erase(unique(ids.begin(), ids.end()), ids.end());
+
+        vector<string> tokens;
+        size_t start = 0;
+        while (start < before.size()) {
+            size_t space = before.find(' ', start);
+            if (space == string::npos) space = before.size();
+            if (space > start) tokens.push_back(before.substr(start, space - start));
+            start = space + 1;
+        }
+        for (size_t i = 0; i < ids.size();) {
+            size_t j = i;
+            while (j + 1 < ids.size() && ids[j + 1] == ids[j] + 1) ++j;
+            tokens.push_back(to_string(ids[i]));
+            if (j >= i + 2) {
+                tokens.push_back("TO");
+                tokens.push_back(to_string(ids[j]));
+                i = j + 1;
+            }
+            else {
+                ++i;
+            }
+        }
+        start = 0;
+        while (start < after.size()) {
+            size_t space = after.find(' ', start);
+            if (space == string::npos) space = after.size();
+            if (space > start) tokens.push_back(after.substr(start, space - start));
+            start = space + 1;
+        }
+        AppendTokens(out, tokens);
+    }
+
+    // FIXED, PINNED or FIXED BUT with the released directions and the
+    // springs. Empty for a joint with nothing restrained.
+    string SupportText(uint8_t key, const double* stiffness) {
+        double released[6];
+        switch (SupportSpec::Describe(key, stiffness, released)) {
+        case SupportSpec::Kind::None: return string();
+        case SupportSpec::Kind::Fixed: return "FIXED";
+        case SupportSpec::Kind::Pinned: return "PINNED";
+        default: break;
+        }
+
+        string spec = "FIXED BUT";
+        for (int i = 0; i < 6; ++i) {
+            if (released[i] != 0.0) {
+                spec += ' ';
+                spec += kDofNames[i];
+            }
+        }
+        for (int i = 0; i < 6; ++i) {
+            if (stiffness[i] == 0.0) continue;
+            spec += " K";
+            spec += kDofNames[i];
+            spec += ' ';
+            AppendNumber(spec, stiffness[i]);
+        }
+        return spec;
+    }
+
+    // Titles are the rest of the line
+    string Title(const string& name) {
+        string title = name;
+        replace(title.begin(), title.end(), '\n', ' ');
+        replace(title.begin(), title.end(), '\r', ' ');
+        return title;
+    }
+}
+
+bool StdFileBackend::NewModel(const string& stdPath, const UnitSystem& units, UpAxis up) {
+    if (!units.IsValid()) {
+        cerr << "ERROR: Invalid STAAD units " << units.lengthUnit << ", " << units.forceUnit << endl;
+        return false;
+    }
+    path_ = stdPath;
+    units_ = units;
+    up_ = up;
+    nodeIds_.clear();
+    joints_.clear();
+    members_.clear();
+    offsets_.clear();
+    constants_.clear();
+    supports_.clear();
+    loads_.clear();
+    return true;
+}
+
+long StdFileBackend::StaadNode(uint32_t jointLabel) const {
+    return jointLabel < nodeIds_.size() ? nodeIds_[jointLabel] : 0;
+}
+
+bool StdFileBackend::CreateNodes(ModelVector<Node>& nodes) {
+    uint32_t labels = 0;
+    for (const auto& node : nodes) labels = max(labels, node.sapId + 1);
+    nodeIds_.assign(labels, 0);
+    joints_ = "JOINT COORDINATES\n";
+    joints_.reserve(joints_.size() + nodes.size() * 40);
+    for (auto& node : nodes) {
+        long staadId = node.staadId;
+        joints_ += to_string(staadId);
+        joints_ += ' ';
+        AppendNumber(joints_, node.x);
+        joints_ += ' ';
+        AppendNumber(joints_, node.y);
+        joints_ += ' ';
+        AppendNumber(joints_, node.z);
+        joints_ += ";\n";
+        if (nodeIds_[node.sapId] == 0) nodeIds_[node.sapId] = staadId;
+    }
+    return true;
+}
+
+template <typename Member>
+bool StdFileBackend::AppendMembers(ModelVector<Member>& members) {
+    if (members.empty()) return true;
+    if (members_.empty()) members_ = "MEMBER INCIDENCES\n";
+    bool allCreated = true;
+    for (auto& member : members) {
+        long start = StaadNode(member.startNodeId);
+        long end = StaadNode(member.endNodeId);
+        if (start == 0 || end == 0) {
+            cerr << "Warning: Member " << member.staadId << " references a joint that was not created" << endl;
+            allCreated = false;
+            continue;
+        }
+        members_ += to_string(member.staadId);
+        members_ += ' ';
+        members_ += to_string(start);
+        members_ += ' ';
+        members_ += to_string(end);
+        members_ += ";\n";
+    }
+    return allCreated;
+}
+
+bool StdFileBackend::CreateBeams(ModelVector<Beam>& beams) {
+    return AppendMembers(beams);
+}
+
+bool StdFileBackend::CreateCables(ModelVector<Cable>& cables) {
+    return AppendMembers(cables);
+}
+
+bool StdFileBackend::CreateSupports(const ModelVector<JointRestraint>& restraints,
+    const ModelVector<JointSpring>& springs) {
+    // Same single pass as the COM path, grouped by the support text
+    map<string, vector<long>> nodesBySpec;
+    const double noSpring[6] = {};
+    auto r = restraints.begin();
+    auto s = springs.begin();
+    while (r != restraints.end() || s != springs.end()) {
+        uint32_t jointId;
+        uint8_t key = 0;
+        const double* stiffness = noSpring;
+        array<double, 6> spring{};
+
+        if (s == springs.end() || (r != restraints.end() && r->jointId < s->jointId)) {
+            jointId = r->jointId;
+            key = SupportSpec::DofKey(*r++);
+        }
+        else {
+            jointId = s->jointId;
+            if (r != restraints.end() && r->jointId == jointId) key = SupportSpec::DofKey(*r++);
+            spring = { s->U1, s->U2, s->U3, s->R1, s->R2, s->R3 };
+            stiffness = spring.data();
+            ++s;
+        }
+
+        long staadId = StaadNode(jointId);
+        if (staadId == 0) {
+            cerr << "Warning: Joint label #" << jointId << " not found in node map" << endl;
+            continue;
+        }
+        string spec = SupportText(key, stiffness);
+        if (!spec.empty()) nodesBySpec[spec].push_back(staadId);
+    }
+
+    supports_.clear();
+    if (nodesBySpec.empty()) return true;
+    supports_ = "SUPPORTS\n";
+    for (const auto& group : nodesBySpec) {
+        AppendList(supports_, string(), group.second, group.first);
+    }
+    return true;
+}
+
+bool StdFileBackend::AssignBetaAngles(const ModelVector<Beam>& beams) {
+    // One line per distinct angle; beta 0 is STAAD's default
+    map<double, vector<long>> membersByBeta;
+    for (const auto& beam : beams) {
+        if (beam.beta == 0.0) continue;
+        membersByBeta[beam.beta].push_back(beam.staadId);
+    }
+
+    constants_.clear();
+    if (membersByBeta.empty()) return true;
+    constants_ = "CONSTANTS\n";
+    for (const auto& group : membersByBeta) {
+        AppendList(constants_, "BETA " + NumberText(group.first) + " MEMB", group.second, string());
+    }
+    return true;
+}
+
+bool StdFileBackend::AssignMemberOffsets(const ModelVector<FrameInsertion>& insertions,
+    const ModelVector<Beam>& beams) {
+    // Grouped by (end, axes, vector) as in the COM path
+    typedef tuple<int, bool, double, double, double> OffsetKey;
+    map<OffsetKey, vector<long>> membersByOffset;
+    for (const auto& beam : beams) {
+        auto it = lower_bound(insertions.begin(), insertions.end(), beam.sapId,
+            [](const FrameInsertion& a, uint32_t id) { return a.frameId < id; });
+        if (it == insertions.end() || it->frameId != beam.sapId) continue;
+
+        long staadId = beam.staadId;
+        for (int end = 0; end < 2; ++end) {
+            const double* offset = end == 0 ? it->offsetI : it->offsetJ;
+            if (offset[0] == 0.0 && offset[1] == 0.0 && offset[2] == 0.0) continue;
+            membersByOffset[OffsetKey(end, it->local, offset[0], offset[1], offset[2])].push_back(staadId);
+        }
+    }
+
+    offsets_.clear();
+    if (membersByOffset.empty()) return true;
+    offsets_ = "MEMBER OFFSET\n";
+    for (const auto& group : membersByOffset) {
+        string spec = get<0>(group.first) == 0 ? "START" : "END";
+        if (get<1>(group.first)) spec += " LOCAL";
+        spec += ' ' + NumberText(get<2>(group.first));
+        spec += ' ' + NumberText(get<3>(group.first));
+        spec += ' ' + NumberText(get<4>(group.first));
+        AppendList(offsets_, string(), group.second, spec);
+    }
+    return true;
+}
+
+bool StdFileBackend::CreateLoadCombinations(const vector<string>& patternNames,
+    const vector<string>& comboNames,
+    const CombinationMatrix& combinations) {
+    loads_.clear();
+    if (combinations.Rows() == 0) return true;
+
+    // Numbered like the COM path: patterns from 1, combinations from the
+    // next hundred
+    for (size_t p = 0; p < patternNames.size(); ++p) {
+        loads_ += "LOAD " + to_string(p + 1) + " TITLE " + Title(patternNames[p]) + "\n";
+    }
+    const long firstNumber = LoadCombinations::FirstLoadNumber(patternNames.size());
+    vector<string> tokens;
+    for (size_t r = 0; r < combinations.Rows(); ++r) {
+        loads_ += "LOAD COMB " + to_string(firstNumber + r) + " " +
+            Title(comboNames[combinations.combos[r]]) + "\n";
+        tokens.clear();
+        for (uint32_t e = combinations.offsets[r]; e < combinations.offsets[r + 1]; ++e) {
+            tokens.push_back(to_string(combinations.patterns[e] + 1));
+            tokens.push_back(NumberText(combinations.factors[e]));
+        }
+        AppendTokens(loads_, tokens);
+    }
+    return true;
+}
+
+bool StdFileBackend::Save() {
+    ofstream output(filesystem::u8path(path_), ios::binary);
+    if (!output.is_open()) {
+        cerr << "ERROR: Could not write " << path_ << endl;
+        return false;
+    }
+    output << "STAAD SPACE\n"
+        << "INPUT WIDTH " << kInputWidth << "\n";
+    if (up_ == UpAxis::Z) output << "SET Z UP\n";
+    output << "UNIT " << kLengthNames[units_.lengthUnit] << " " << kForceNames[units_.forceUnit] << "\n"
+        << joints_ << members_ << offsets_ << constants_ << supports_ << loads_
+        << "FINISH\n";
+    return output.good();
+}
@@ -0,0 +1,43 @@
+#pragma once
+#include <string>
+#include <utility>
+#include <vector>
+#include "StaadBackend.h"
+
+// Writes the STAAD input file directly: joints, members, supports, beta
+// angles, member offsets, primary loads and combinations. Blocks are kept in
+// memory and written in STAAD's order on Save.
+class StdFileBackend : public StaadBackend {
+public:
+    const char* Name() const override { return "file"; }
+    bool Open() override { return true; }
+    bool SupportsUpAxis(UpAxis) const override { return true; } // SET Z UP
+    bool NewModel(const std::string& stdPath, const UnitSystem& units, UpAxis up) override;
+    bool CreateNodes(ModelVector<Node>& nodes) override;
+    bool CreateBeams(ModelVector<Beam>& beams) override;
+    bool CreateCables(ModelVector<Cable>& cables) override;
+    bool CreateSupports(const ModelVector<JointRestraint>& restraints,
+        const ModelVector<JointSpring>& springs) override;
+    bool AssignBetaAngles(const ModelVector<Beam>& beams) override;
+    bool AssignMemberOffsets(const ModelVector<FrameInsertion>& insertions,
+        const ModelVector<Beam>& beams) override;
+    bool CreateLoadCombinations(const std::vector<std::string>& patternNames,
+        const std::vector<std::string>& comboNames,
+        const CombinationMatrix& combinations) override;
+    bool Save() override;
+private:
+    template <typename Member>
+    bool AppendMembers(ModelVector<Member>& members);
+    long StaadNode(uint32_t jointLabel) const;
+
+    std::string path_;
+    UnitSystem units_;
+    UpAxis up_ = UpAxis::Y;
+    std::vector<long> nodeIds_; // Joint label -> STAAD number, 0 if not created
+    std::string joints_;
+    std::string members_;
+    std::string offsets_;
+    std::string constants_;
+    std::string supports_;
+    std::string loads_;
+};
@@ -0,0 +1,22 @@
+#include "SupportSpec.h"
+
+uint8_t SupportSpec::DofKey(const JointRestraint& r) {
+    return static_cast<uint8_t>(
+        (r.U1 ? 1 : 0) | (r.U2 ? 2 : 0) | (r.U3 ? 4 : 0) |
+        (r.R1 ? 8 : 0) | (r.R2 ? 16 : 0) | (r.R3 ? 32 : 0));
+}
+
+SupportSpec::Kind SupportSpec::Describe(uint8_t key, const double* stiffness, double released[6]) {
+    bool hasSpring = false;
+    for (int i = 0; i < 6; ++i) {
+        bool sprung = stiffness && stiffness[i] != 0.0;
+        hasSpring = hasSpring || sprung;
+        released[i] = ((key >> i) & 1) || sprung ? 0.0 : 1.0;
+    }
+    if (!hasSpring) {
+        if (key == 0) return Kind::None;
+        if (key == 63) return Kind::Fixed;
+        if (key == 7) return Kind::Pinned;
+    }
+    return Kind::FixedBut;
+}
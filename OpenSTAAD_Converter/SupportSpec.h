@@ -0,0 +1,17 @@
+#pragma once
+#include <cstdint>
+#include "SAP2000Parser.h"
+
+// How a joint's restraints and springs become a STAAD support, shared by the
+// backends so the .std file and OpenSTAAD describe the same support.
+namespace SupportSpec {
+    enum class Kind { None, Fixed, Pinned, FixedBut };
+
+    // 6-bit DOF key: bit 0..5 = U1 U2 U3 R1 R2 R3 restrained
+    uint8_t DofKey(const JointRestraint& restraint);
+
+    // Nothing restrained and no spring is no support at all. For FixedBut,
+    // released[i] is 1 for the DOFs that are neither restrained nor sprung,
+    // in U1 U2 U3 R1 R2 R3 order; stiffness may be null for no springs.
+    Kind Describe(uint8_t key, const double* stiffness, double released[6]);
+}
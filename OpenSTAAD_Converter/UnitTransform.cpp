@@ -0,0 +1,136 @@
+#include "UnitTransform.h"
+#include "Parallel.h"
+#include <iostream>
+#include <utility>
+
+using namespace std;
+
+namespace {
+    // Plain per-array loops over contiguous doubles so the compiler can
+    // vectorize them; no per-element branches.
+    void ScaleRange(double* values, size_t begin, size_t end, double factor) {
+        for (size_t i = begin; i < end; ++i) {
+            values[i] *= factor;
+        }
+    }
+
+    void SwapAxes(JointRestraint& r) {
+        swap(r.U2, r.U3);
+        swap(r.R2, r.R3);
+    }
+
+    void SwapAxes(JointSpring& s) {
+        swap(s.U2, s.U3);
+        swap(s.R2, s.R3);
+    }
+
+    // Same remap as the coordinates, for a global offset vector
+    void RemapOffset(double* offset, double scale, UpAxis targetUp) {
+        double y = offset[1];
+        double z = offset[2];
+        offset[0] *= scale;
+        offset[1] = (targetUp == UpAxis::Y ? z : -z) * scale;
+        offset[2] = (targetUp == UpAxis::Y ? -y : y) * scale;
+    }
+}
+
+double UnitTransform::LengthToMeters(int lengthUnit) {
+    switch (lengthUnit) {
+    case 0: return 0.0254;
+    case 1:
+    case 2: return 0.3048;
+    case 3: return 0.01;
+    case 4: return 1.0;
+    case 5: return 0.001;
+    case 6: return 0.1;
+    case 7: return 1000.0;
+    default: return 0.0;
+    }
+}
+
+double UnitTransform::ForceToNewtons(int forceUnit) {
+    switch (forceUnit) {
+    case 0: return 4448.2216152605;
+    case 1: return 4.4482216152605;
+    case 2: return 9.80665;
+    case 3: return 9806.65;
+    case 4: return 1.0;
+    case 5: return 1000.0;
+    case 6: return 1.0e6;
+    case 7: return 10.0;
+    default: return 0.0;
+    }
+}
+
+void UnitTransform::TransformCoordinates(CoordinateArrays& coordinates, double scale,
+    UpAxis sourceUp, UpAxis targetUp, bool parallel) {
+    // Right-handed remap: Z-up (x, y, z) -> Y-up (x, z, -y), and back
+    // Y-up (x, y, z) -> Z-up (x, -z, y). The swap is O(1) on the arrays,
+    // the sign folds into the per-axis scale factor.
+    double scaleY = scale;
+    double scaleZ = scale;
+    if (sourceUp != targetUp) {
+        coordinates.y.swap(coordinates.z);
+        if (targetUp == UpAxis::Y) scaleZ = -scale;
+        else scaleY = -scale;
+    }
+    if (scale == 1.0 && sourceUp == targetUp) return;
+
+    double* x = coordinates.x.data();
+    double* y = coordinates.y.data();
+    double* z = coordinates.z.data();
+    Parallel::For(coordinates.size(), [=](size_t begin, size_t end) {
+        ScaleRange(x, begin, end, scale);
+        ScaleRange(y, begin, end, scaleY);
+        ScaleRange(z, begin, end, scaleZ);
+    }, parallel);
+}
+
+bool UnitTransform::Apply(SAP2000Model& model, const TransformOptions& options) {
+    double lengthScale = 1.0;
+    double forceScale = 1.0;
+    if (options.target.IsValid()) {
+        if (!model.units.IsValid()) {
+            cerr << "Cannot rescale: model units are unknown" << endl;
+            return false;
+        }
+        lengthScale = LengthToMeters(model.units.lengthUnit) / LengthToMeters(options.target.lengthUnit);
+        forceScale = ForceToNewtons(model.units.forceUnit) / ForceToNewtons(options.target.forceUnit);
+    }
+
+    bool remap = model.upAxis != options.targetUp;
+    TransformCoordinates(model.coordinates, lengthScale, model.upAxis, options.targetUp, options.parallel);
+    model.StoreCoordinates();
+
+    if (remap) {
+        for (auto& restraint : model.restraints) SwapAxes(restraint);
+    }
+    // Translational springs are force/length, rotational ones force*length/rad
+    const double translational = forceScale / lengthScale;
+    const double rotational = forceScale * lengthScale;
+    for (auto& spring : model.springs) {
+        if (remap) SwapAxes(spring);
+        spring.U1 *= translational; spring.U2 *= translational; spring.U3 *= translational;
+        spring.R1 *= rotational; spring.R2 *= rotational; spring.R3 *= rotational;
+    }
+
+    // Local offsets follow the member, so only global ones are remapped
+    for (auto& insertion : model.insertions) {
+        if (remap && !insertion.local) {
+            RemapOffset(insertion.offsetI, lengthScale, options.targetUp);
+            RemapOffset(insertion.offsetJ, lengthScale, options.targetUp);
+            continue;
+        }
+        for (int c = 0; c < 3; ++c) {
+            insertion.offsetI[c] *= lengthScale;
+            insertion.offsetJ[c] *= lengthScale;
+        }
+    }
+
+    if (options.target.IsValid()) model.units = options.target;
+    model.upAxis = options.targetUp;
+
+    cout << "Transformed " << model.coordinates.size() << " joints: length x" << lengthScale
+        << ", force x" << forceScale << (remap ? ", axes remapped" : "") << endl;
+    return true;
+}
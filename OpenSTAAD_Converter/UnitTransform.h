@@ -0,0 +1,22 @@
+#pragma once
+#include "SAP2000Model.h"
+
+struct TransformOptions {
+    UnitSystem target;            // Invalid means keep the model units
+    UpAxis targetUp = UpAxis::Y;  // STAAD default global axes
+    bool parallel = true;
+};
+
+namespace UnitTransform {
+    double LengthToMeters(int lengthUnit);
+    double ForceToNewtons(int forceUnit);
+
+    // Scales the coordinate arrays and remaps Z-up <-> Y-up in place.
+    void TransformCoordinates(CoordinateArrays& coordinates, double scale,
+        UpAxis sourceUp, UpAxis targetUp, bool parallel = true);
+
+    // Brings coordinates, restraints, springs and insertion offsets to the
+    // target units and axes.
+    // Returns false if the model units are unknown and a rescale was requested.
+    bool Apply(SAP2000Model& model, const TransformOptions& options);
+}
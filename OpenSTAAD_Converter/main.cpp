@@ -1,17 +1,25 @@
+#ifdef _WIN32
 #define NOMINMAX
 #define _SILENCE_CXX17_CODECVT_HEADER_DEPRECATION_WARNING
 #include <windows.h>
-#include <comdef.h>
+#endif
 #include <iostream>
+#include <memory>
 #include <string>
+#include <vector>
 #include <filesystem>
 #include "SAP2000Parser.h"
-#include "STAADWrapper.h"
-#include "STAADUtilities.h"
+#include "ConversionPipeline.h"
+#include "ConversionService.h"
+#include "StdFileBackend.h"
+#ifdef _WIN32
+#include "ComBackend.h"
+#endif
 
 namespace fs = std::filesystem;
 using namespace std;
 
+#ifdef _WIN32
 std::wstring UTF8ToWide(const std::string& utf8) {
     if (utf8.empty()) return L"";
     int size = MultiByteToWideChar(CP_UTF8, 0, utf8.c_str(), -1, nullptr, 0);
@@ -25,6 +33,7 @@ bool FileExistsWinAPI(const std::wstring& path) {
     DWORD attrs = GetFileAttributesW(path.c_str());
     return (attrs != INVALID_FILE_ATTRIBUTES && !(attrs & FILE_ATTRIBUTE_DIRECTORY));
 }
+#endif
 
 void PrintLengthUnits() {
     cout << "\nLength units available:\n";
@@ -36,25 +45,129 @@ void PrintForceUnits() {
     cout << "0: Kilopound\n1: Pound\n2: Kilogram\n3: Metric Ton\n4: Newton\n5: Kilo Newton\n6: Mega Newton\n7: DecaNewton\n";
 }
 
+void PrintUsage() {
+    cout << "Usage: OpenSTAAD_Converter [options] <model.$2k[.gz|.zst]>\n"
+        << "       OpenSTAAD_Converter --service [--backend B] [--endpoint NAME]\n"
+        << "       OpenSTAAD_Converter --submit [options] <model.$2k>...\n"
+        << "       OpenSTAAD_Converter --status | --shutdown\n";
+    ConversionPipeline::PrintOptions(cout);
+    cout << "  --backend B       staad (default on Windows) or file, which writes the .std without STAAD.Pro\n"
+        << "  --service         Keep the backend open and convert jobs sent by --submit, one at a time\n"
+        << "  --submit          Queue the files on a running service and follow their progress\n"
+        << "  --status          Show the service queue\n"
+        << "  --shutdown        Stop the service after the running job\n"
+        << "  --endpoint NAME   Service pipe or socket name (default: sap2staad)\n";
+}
+
+std::unique_ptr<StaadBackend> MakeBackend(const std::string& name) {
+    if (name == "file") return std::make_unique<StdFileBackend>();
+#ifdef _WIN32
+    if (name == "staad") return std::make_unique<ComBackend>();
+#else
+    if (name == "staad") {
+        cerr << "The staad backend needs STAAD.Pro on Windows; use --backend file\n";
+        return nullptr;
+    }
+#endif
+    cerr << "Unknown backend: " << name << "\n";
+    return nullptr;
+}
+
+void PrintProgress(const char*, int, const std::string& message) {
+    if (message.empty()) return;
+    cout << message;
+    if (message.back() != '\n') cout << '\n';
+    cout.flush();
+}
+
+// Units come from PROGRAM CONTROL; only asked when the table is missing
+bool AskUnits(UnitSystem& units) {
+    PrintLengthUnits();
+    cout << "Enter length unit from file input: ";
+    cin >> units.lengthUnit;
+    if (units.lengthUnit < 0 || units.lengthUnit > 7) {
+        cerr << "Invalid option.\n";
+        return false;
+    }
+
+    PrintForceUnits();
+    cout << "Enter force unit from file input: ";
+    cin >> units.forceUnit;
+    if (units.forceUnit < 0 || units.forceUnit > 7) {
+        cerr << "Invalid option.\n";
+        return false;
+    }
+    return true;
+}
+
 int main(int argc, char* argv[]) {
     std::cerr << "\nCreated by Angel Monroy Canales\n";
     std::cerr << "Contact info: monolitoingenieria@gmail.com\n\n";
     std::cerr << "Checking system configuration, please wait...\n";
 
-    HRESULT hr = CoInitializeEx(NULL, COINIT_APARTMENTTHREADED);
-    if (FAILED(hr)) {
-        std::cerr << "Failed to initialize COM" << std::endl;
-        return 1;
+    enum class Mode { Convert, Service, Submit, Status, Shutdown } mode = Mode::Convert;
+#ifdef _WIN32
+    std::string backendName = "staad";
+#else
+    std::string backendName = "file";
+#endif
+    std::string endpoint = "sap2staad";
+    std::vector<std::string> args;
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        if (arg == "--service") mode = Mode::Service;
+        else if (arg == "--submit") mode = Mode::Submit;
+        else if (arg == "--status") mode = Mode::Status;
+        else if (arg == "--shutdown") mode = Mode::Shutdown;
+        else if (arg == "--backend" && i + 1 < argc) backendName = argv[++i];
+        else if (arg == "--endpoint" && i + 1 < argc) endpoint = argv[++i];
+        else args.push_back(arg);
     }
 
-    try {
-        std::wstring widePath;
+    ConversionJob job;
+    std::vector<std::string> inputs, options;
+    std::string error;
+    if (!ConversionPipeline::ParseArguments(args, job, inputs, options, error)) {
+        cerr << error << "\n";
+        PrintUsage();
+        return 1;
+    }
 
-        if (argc >= 2) {
-            widePath = UTF8ToWide(argv[1]);
+    switch (mode) {
+    case Mode::Status:
+        return ConversionClient::Command(endpoint, "STATUS");
+    case Mode::Shutdown:
+        return ConversionClient::Command(endpoint, "SHUTDOWN");
+    case Mode::Submit:
+        if (inputs.empty()) {
+            PrintUsage();
+            return 1;
         }
-        else {
-            std::wcout << L"Enter SAP2000 .$2k file path: ";
+        // The service resolves relative paths against its own directory
+        for (auto& input : inputs) input = fs::absolute(fs::u8path(input)).u8string();
+        for (size_t i = 0; i + 1 < options.size(); ++i) {
+            if (options[i] == "--output-dir") options[i + 1] = fs::absolute(fs::u8path(options[i + 1])).u8string();
+        }
+        return ConversionClient::Submit(endpoint, options, inputs);
+    default:
+        break;
+    }
+
+    std::unique_ptr<StaadBackend> backend = MakeBackend(backendName);
+    if (!backend) {
+        PrintUsage();
+        return 1;
+    }
+    if (mode == Mode::Service) {
+        ConversionService service(*backend, endpoint);
+        return service.Run();
+    }
+
+    try {
+#ifdef _WIN32
+        std::wstring widePath = inputs.empty() ? std::wstring() : UTF8ToWide(inputs.back());
+        if (widePath.empty()) {
+            std::wcout << L"Enter SAP2000 .$2k file path (.gz/.zst accepted): ";
             std::wstring input;
             std::getline(std::wcin, input);
             widePath = input;
@@ -64,8 +177,6 @@ int main(int argc, char* argv[]) {
             widePath = widePath.substr(1, widePath.size() - 2);
         }
 
-        std::wcout << L"Processing file: " << widePath << std::endl;
-
         if (!FileExistsWinAPI(widePath)) {
             std::wcerr << L"ERROR: File not found (WinAPI check failed)\n";
 
@@ -87,97 +198,42 @@ int main(int argc, char* argv[]) {
             std::wcerr << L"Attempted path: " << widePath << std::endl;
             return 1;
         }
-
-        fs::path filePath(widePath);
-
-        fs::path outputDir = R"(C:\temp)";
-        if (!fs::exists(outputDir)) {
-            if (!fs::create_directory(outputDir)) {
-                std::cerr << "Failed to create output directory at C:\\temp" << std::endl;
-                CoUninitialize();
-                return 1;
-            }
+        job.inputPath = fs::path(widePath).u8string();
+#else
+        std::string path = inputs.empty() ? std::string() : inputs.back();
+        if (path.empty()) {
+            std::cout << "Enter SAP2000 .$2k file path (.gz/.zst accepted): ";
+            std::getline(std::cin, path);
         }
-
-        auto sections = SAP2000Parser::ParseFile(filePath.string());
-        auto nodes = SAP2000Parser::ExtractNodes(filePath.string(), sections.ijoint + 1);
-        auto beams = SAP2000Parser::ExtractBeams(filePath.string(), sections.iconnection + 1, {});
-        auto cables = SAP2000Parser::ExtractCables(filePath.string(), sections.icable + 1, {});
-        auto restraints = SAP2000Parser::ExtractJointRestraints(filePath.string(), sections.isupport + 1);
-
-        std::string outputName = filePath.stem().string() + ".std";
-        fs::path outputPath = outputDir / outputName;
-
-        int lenUnit = -1;
-        int forceUnit = -1;
-
-        PrintLengthUnits();
-        cout << "Enter length unit from file input: ";
-        cin >> lenUnit;
-        if (lenUnit < 0 || lenUnit > 7) {
-            cerr << "Invalid option.\n";
-            return 1;
-        }
-
-        PrintForceUnits();
-        cout << "Enter force unit from file input: ";
-        cin >> forceUnit;
-        if (forceUnit < 0 || forceUnit > 7) {
-            cerr << "Invalid option.\n";
-            return 1;
+        if (path.size() >= 2 && path.front() == '"' && path.back() == '"') {
+            path = path.substr(1, path.size() - 2);
         }
+        job.inputPath = path;
+#endif
 
-        auto staadApp = STAADWrapper::Initialize(outputPath.wstring(), lenUnit, forceUnit);
-        if (staadApp == nullptr) {
-            cerr << "Failed to initialize STAAD" << endl;
-            CoUninitialize();
+        if (!backend->Open()) {
+            cerr << "Failed to open the " << backend->Name() << " backend" << endl;
             return 1;
         }
 
-        OpenSTAADUI::IOSGeometryUIPtr geometry = staadApp->GetGeometry();
-        //staadApp->SetSilentMode(1);
-
-        try {
-            STAADUtilities::WaitForGeometryReady(geometry);
-        }
-        catch (const std::exception& e) {
-            std::cerr << "Error: " << e.what() << std::endl;
+        ConversionResult result = ConversionPipeline::Run(job, *backend, PrintProgress, AskUnits);
+        if (!result.ok) {
+            cerr << result.error << endl;
             return 1;
         }
-        if (!STAADWrapper::CreateNodes(geometry, nodes)) {
-            std::cerr << "Failed to create nodes" << std::endl;
-        }
-
-        if (!STAADWrapper::CreateBeams(geometry, beams, STAADWrapper::GetNodeMap())) {
-            std::cerr << "Failed to create beams" << std::endl;
-        }
-
-        if (!STAADWrapper::CreateCables(geometry, cables, STAADWrapper::GetNodeMap())) {
-            std::cerr << "Failed to create cables" << std::endl;
-        }
-        /*
-        if (!STAADWrapper::CreatePlates(geometry, plates, STAADWrapper::GetNodeMap())) {
-            std::cerr << "Failed to create plates" << std::endl;
-        }
-        */
-
-        OpenSTAADUI::IOSSupportUIPtr Supports = staadApp->GetSupport();
-
-        if (!STAADWrapper::CreateSupports(Supports, restraints, STAADWrapper::GetNodeMap())) {
-            std::cerr << "Failed to create supports" << std::endl;
-        }
-
-        std::wcout << L"Conversion complete! Saved to: " << outputPath.wstring() << std::endl;
     }
     catch (const std::exception& e) {
         std::cerr << "Error: " << e.what() << std::endl;
+        return 1;
     }
     catch (...) {
         std::cerr << "Unknown error occurred" << std::endl;
+        return 1;
     }
 
-    CoUninitialize();
     std::cout << "Program finished successfully.\n";
+#ifdef _WIN32
     system("pause");
+#endif
     return 0;
-}
\ No newline at end of file
+}
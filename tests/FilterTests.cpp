@@ -0,0 +1,86 @@
+#include "TestSupport.h"
+#include "ConversionFilter.h"
+
+using namespace std;
+
+namespace {
+    // Portal frame 1-2-3-4, a braced cable 1-3 and frame 4 hanging off a
+    // joint that does not exist
+    const char* kModel =
+        "TABLE:  \"JOINT COORDINATES\"\n"
+        "   Joint=1   XorR=0   Y=0   Z=0\n"
+        "   Joint=2   XorR=0   Y=0   Z=3\n"
+        "   Joint=3   XorR=5   Y=0   Z=3\n"
+        "   Joint=4   XorR=5   Y=0   Z=0\n"
+        "   Joint=5   XorR=20   Y=20   Z=0\n"
+        "\n"
+        "TABLE:  \"JOINT RESTRAINT ASSIGNMENTS\"\n"
+        "   Joint=1   U1=Yes   U2=Yes   U3=Yes   R1=Yes   R2=Yes   R3=Yes\n"
+        "   Joint=5   U1=Yes   U2=Yes   U3=Yes   R1=No   R2=No   R3=No\n"
+        "\n"
+        "TABLE:  \"GROUPS 2 - ASSIGNMENTS\"\n"
+        "   GroupName=G1   ObjectType=Frame   ObjectLabel=2\n"
+        "   GroupName=G1   ObjectType=Frame   ObjectLabel=4\n"
+        "   GroupName=BASE   ObjectType=Joint   ObjectLabel=1\n"
+        "\n"
+        "TABLE:  \"CONNECTIVITY - FRAME\"\n"
+        "   Frame=1   JointI=1   JointJ=2\n"
+        "   Frame=2   JointI=2   JointJ=3\n"
+        "   Frame=3   JointI=3   JointJ=4\n"
+        "   Frame=4   JointI=5   JointJ=99\n"
+        "\n"
+        "TABLE:  \"CONNECTIVITY - CABLE\"\n"
+        "   Cable=10   JointI=1   JointJ=3\n"
+        "\n";
+
+    void TestGroupWithDanglingMember() {
+        auto model = Test::LoadModel("filter_group.s2k", kModel);
+        ModelIndex index(*model);
+        FilterOptions options;
+        options.groups = { "G1" };
+        options.hops = 1;
+        Selection selection = index.Select(options);
+
+        // Frame 2 and its joints, then one hop; frame 4 is kept for the
+        // validator with the one joint it has
+        CHECK_EQ(selection.memberCount, size_t(5));
+        CHECK_EQ(selection.jointCount, size_t(5));
+        CHECK(selection.boundary.empty());
+
+        ConversionFilter::Apply(*model, selection);
+        CHECK_EQ(model->beams.size(), size_t(4));
+        CHECK_EQ(model->cables.size(), size_t(1));
+        CHECK_EQ(model->restraints.size(), size_t(2));
+    }
+
+    void TestBoxAndBoundary() {
+        auto model = Test::LoadModel("filter_box.s2k", kModel);
+        ModelIndex index(*model);
+        FilterOptions options;
+        options.useBox = true;
+        options.box.min[0] = -1; options.box.min[1] = -1; options.box.min[2] = 2;
+        options.box.max[0] = 6; options.box.max[1] = 1; options.box.max[2] = 4;
+        Selection selection = index.Select(options);
+
+        // Only the beam of the portal and the top of the cable lie in the box;
+        // members crossing it come with both their joints
+        CHECK_EQ(selection.memberCount, size_t(4));
+        CHECK_EQ(selection.jointCount, size_t(4));
+        CHECK(selection.members[1]);
+        CHECK(!selection.members[3]);
+        CHECK(selection.boundary.empty());
+
+        options.box.max[0] = 1; // Only joint 2 and the column below it
+        selection = index.Select(options);
+        CHECK_EQ(selection.memberCount, size_t(2));
+        CHECK_EQ(selection.jointCount, size_t(3));
+        CHECK(!selection.boundary.empty());
+        CHECK(ConversionFilter::WriteBoundary(*model, selection, "filter_boundary.txt"));
+    }
+}
+
+int main() {
+    TestGroupWithDanglingMember();
+    TestBoxAndBoundary();
+    return Test::Result();
+}
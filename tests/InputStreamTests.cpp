@@ -0,0 +1,232 @@
+#include "TestSupport.h"
+#include "InputStream.h"
+#include <algorithm>
+#include <cstring>
+#include <iterator>
+
+#if __has_include(<zlib.h>)
+#include <zlib.h>
+#define SAP2K_TEST_ZLIB 1
+#endif
+
+#if __has_include(<zstd.h>)
+#include <zstd.h>
+#define SAP2K_TEST_ZSTD 1
+#endif
+
+using namespace std;
+
+namespace {
+    // Table-like text big enough to span several read chunks
+    string SampleText(size_t rows) {
+        ostringstream text;
+        text << "TABLE:  \"JOINT COORDINATES\"\n";
+        for (size_t i = 1; i <= rows; ++i) {
+            text << "   Joint=" << i << "   CoordSys=GLOBAL   XorR=" << i % 97 << "   Y=0   Z=" << i % 13 << "\n";
+        }
+        return text.str();
+    }
+
+    string ReadLine(const InputText& text, long line) {
+        auto input = text.OpenAt(line);
+        string value;
+        getline(*input, value);
+        return value;
+    }
+
+    string ReadAll(const InputText& text) {
+        auto input = text.OpenAt(1);
+        return string((istreambuf_iterator<char>(*input)), istreambuf_iterator<char>());
+    }
+
+    // Byte offset of every line start, as the section scan records them
+    LineOffsets Offsets(const string& text) {
+        LineOffsets offsets;
+        long line = 1;
+        for (size_t offset = 0; offset < text.size();) {
+            offsets.emplace_back(line++, offset);
+            size_t end = text.find('\n', offset);
+            if (end == string::npos) break;
+            offset = end + 1;
+        }
+        return offsets;
+    }
+
+    // Lines read in and out of file order, after marking some line starts,
+    // must match the text
+    void CheckSeeks(InputText& input, const string& text) {
+        LineOffsets offsets = Offsets(text);
+        LineOffsets marks;
+        for (size_t i = 0; i < offsets.size(); i += offsets.size() / 7 + 1) marks.push_back(offsets[i]);
+        input.Mark(marks);
+        size_t count = offsets.size();
+        for (size_t index : { size_t(1), count / 2, count / 2 + 3, count - 1, count / 3, size_t(0) }) {
+            size_t end = text.find('\n', offsets[index].second);
+            string expected = text.substr(offsets[index].second, end - offsets[index].second);
+            CHECK_EQ(ReadLine(input, offsets[index].first), expected);
+        }
+    }
+
+    void TestOpenAt() {
+        InputText text;
+        CHECK(!text.Load("missing.s2k"));
+        CHECK(text.Load(Test::WriteFile("input_lines.s2k", "first\nsecond\r\n\nfourth")));
+        CHECK_EQ(ReadLine(text, 1), string("first"));
+        CHECK_EQ(ReadLine(text, 2), string("second\r"));
+        CHECK_EQ(ReadLine(text, 3), string());
+        CHECK_EQ(ReadLine(text, 4), string("fourth"));
+
+        // Past the end the stream is simply empty
+        auto past = text.OpenAt(9);
+        string line;
+        CHECK(!getline(*past, line));
+
+        // Streams are independent of each other
+        auto a = text.OpenAt(1);
+        auto b = text.OpenAt(4);
+        getline(*a, line);
+        getline(*b, line);
+        CHECK_EQ(line, string("fourth"));
+        getline(*a, line);
+        CHECK_EQ(line, string("second\r"));
+
+        // Recorded line starts are seeked to, later lines skipped from there
+        text.Mark({ { 2, 6 }, { 4, 15 } });
+        CHECK_EQ(ReadLine(text, 2), string("second\r"));
+        CHECK_EQ(ReadLine(text, 3), string());
+        CHECK_EQ(ReadLine(text, 4), string("fourth"));
+        CHECK_EQ(ReadLine(text, 1), string("first"));
+
+        text.Release();
+        CHECK(text.Path().empty());
+    }
+
+#ifdef SAP2K_TEST_ZLIB
+    string GzipMember(const string& text) {
+        z_stream stream;
+        memset(&stream, 0, sizeof(stream));
+        deflateInit2(&stream, 6, Z_DEFLATED, 15 + 16, 8, Z_DEFAULT_STRATEGY);
+        string out(deflateBound(&stream, static_cast<uLong>(text.size())) + 32, '\0');
+        stream.next_in = reinterpret_cast<Bytef*>(const_cast<char*>(text.data()));
+        stream.avail_in = static_cast<uInt>(text.size());
+        stream.next_out = reinterpret_cast<Bytef*>(&out[0]);
+        stream.avail_out = static_cast<uInt>(out.size());
+        deflate(&stream, Z_FINISH);
+        out.resize(stream.total_out);
+        deflateEnd(&stream);
+        return out;
+    }
+
+    // One BGZF block: a gzip member whose "BC" extra field holds its size
+    string BgzfBlock(const string& text) {
+        z_stream stream;
+        memset(&stream, 0, sizeof(stream));
+        deflateInit2(&stream, 6, Z_DEFLATED, -15, 8, Z_DEFAULT_STRATEGY);
+        string data(deflateBound(&stream, static_cast<uLong>(text.size())) + 8, '\0');
+        stream.next_in = reinterpret_cast<Bytef*>(const_cast<char*>(text.data()));
+        stream.avail_in = static_cast<uInt>(text.size());
+        stream.next_out = reinterpret_cast<Bytef*>(&data[0]);
+        stream.avail_out = static_cast<uInt>(data.size());
+        deflate(&stream, Z_FINISH);
+        data.resize(stream.total_out);
+        deflateEnd(&stream);
+
+        auto le = [](string& out, uint32_t value, int bytes) {
+            for (int b = 0; b < bytes; ++b) out += static_cast<char>((value >> (8 * b)) & 0xff);
+        };
+        string block("\x1f\x8b\x08\x04\0\0\0\0\0\xff\x06\0BC\x02\0", 16);
+        le(block, static_cast<uint32_t>(18 + data.size() + 8 - 1), 2);
+        block += data;
+        le(block, static_cast<uint32_t>(crc32(0, reinterpret_cast<const Bytef*>(text.data()),
+            static_cast<uInt>(text.size()))), 4);
+        le(block, static_cast<uint32_t>(text.size()), 4);
+        return block;
+    }
+
+    void TestBgzip() {
+        const string text = SampleText(100000);
+        string file;
+        for (size_t offset = 0; offset < text.size(); offset += 65280) {
+            file += BgzfBlock(text.substr(offset, 65280));
+        }
+        file += BgzfBlock(string()); // End-of-file marker block
+
+        InputText input;
+        CHECK(input.Load(Test::WriteFile("input.s2k.bgz", file)));
+        CHECK_EQ(ReadLine(input, 100001), string("   Joint=100000   CoordSys=GLOBAL   XorR=90   Y=0   Z=4"));
+        CHECK(ReadAll(input) == text);
+        // The first read recorded the blocks, later lines start from them
+        CheckSeeks(input, text);
+    }
+
+    void TestGzip() {
+        const string text = SampleText(60000);
+        InputText input;
+        CHECK(input.Load(Test::WriteFile("input.s2k.gz", GzipMember(text))));
+        CHECK(InputStream::Detect("input.s2k.gz") == InputFormat::Gzip);
+        CHECK(ReadAll(input) == text && input.Path() == "input.s2k.gz");
+        CheckSeeks(input, text);
+        CHECK_EQ(ReadLine(input, 60001), string("   Joint=60000   CoordSys=GLOBAL   XorR=54   Y=0   Z=5"));
+
+        // Concatenated members read as one text
+        const string half = text.substr(0, text.size() / 2);
+        const string rest = text.substr(text.size() / 2);
+        CHECK(input.Load(Test::WriteFile("input_members.s2k.gz", GzipMember(half) + GzipMember(rest))));
+        CHECK(ReadAll(input) == text);
+        CHECK_EQ(ReadLine(input, 2), string("   Joint=1   CoordSys=GLOBAL   XorR=1   Y=0   Z=1"));
+
+        // A truncated file reports the error and keeps what was decoded
+        string truncated = GzipMember(text);
+        truncated.resize(truncated.size() / 2);
+        CHECK(input.Load(Test::WriteFile("input_truncated.s2k.gz", truncated)));
+        CHECK(ReadAll(input).size() < text.size());
+    }
+#endif
+
+#ifdef SAP2K_TEST_ZSTD
+    // Frames of `frameBytes` input each, with or without the content size
+    string ZstdFrames(const string& text, size_t frameBytes, bool contentSize) {
+        ZSTD_CCtx* context = ZSTD_createCCtx();
+        ZSTD_CCtx_setParameter(context, ZSTD_c_contentSizeFlag, contentSize ? 1 : 0);
+        string file;
+        for (size_t offset = 0; offset < text.size(); offset += frameBytes) {
+            size_t size = min(frameBytes, text.size() - offset);
+            string frame(ZSTD_compressBound(size), '\0');
+            ZSTD_inBuffer in = { text.data() + offset, size, 0 };
+            ZSTD_outBuffer out = { &frame[0], frame.size(), 0 };
+            ZSTD_compressStream2(context, &out, &in, ZSTD_e_end);
+            file.append(frame.data(), out.pos);
+        }
+        ZSTD_freeCCtx(context);
+        return file;
+    }
+
+    void TestZstd() {
+        const string text = SampleText(100000);
+        struct { const char* name; size_t frameBytes; bool contentSize; } cases[] = {
+            { "input_single.s2k.zst", text.size(), true },    // Sequential decoder
+            { "input_frames.s2k.zst", size_t(1) << 20, true }, // Parallel frames
+            { "input_streamed.s2k.zst", size_t(1) << 20, false },
+        };
+        for (const auto& c : cases) {
+            InputText input;
+            CHECK(input.Load(Test::WriteFile(c.name, ZstdFrames(text, c.frameBytes, c.contentSize))));
+            CHECK(InputStream::Detect(c.name) == InputFormat::Zstd);
+            CHECK(ReadAll(input) == text);
+            CheckSeeks(input, text);
+        }
+    }
+#endif
+}
+
+int main() {
+    TestOpenAt();
+#ifdef SAP2K_TEST_ZLIB
+    TestGzip();
+    TestBgzip();
+#endif
+#ifdef SAP2K_TEST_ZSTD
+    TestZstd();
+#endif
+    return Test::Result();
+}
@@ -0,0 +1,115 @@
+#include "TestSupport.h"
+#include "LabelTable.h"
+#include "ModelValidator.h"
+#include <set>
+
+using namespace std;
+
+namespace {
+    void TestIntern() {
+        LabelTable labels;
+        uint32_t a = labels.Intern("12");
+        uint32_t b = labels.Intern("A12");
+        CHECK_EQ(a, 0u);
+        CHECK_EQ(b, 1u);
+        CHECK_EQ(labels.Intern("12"), a);
+        CHECK_EQ(labels.Find("A12"), b);
+        CHECK(labels.Find("a12") == LabelTable::kNone);
+        CHECK_EQ(labels.Text(b), string_view("A12"));
+
+        // Enough labels to rehash several times
+        for (int i = 0; i < 5000; ++i) labels.Intern("N" + to_string(i));
+        CHECK_EQ(labels.size(), size_t(5002));
+        CHECK_EQ(labels.Find("N4999"), 5001u);
+        CHECK_EQ(labels.Text(labels.Find("N1234")), string_view("N1234"));
+        CHECK_EQ(labels.Find("12"), a);
+
+        labels.Clear();
+        CHECK_EQ(labels.size(), size_t(0));
+        CHECK(labels.Find("12") == LabelTable::kNone);
+    }
+
+    void TestNumbering() {
+        // Only canonical positive integers keep their value: "007" would
+        // share a number with "7"
+        LabelTable labels;
+        const char* texts[] = { "B", "7", "007", "0", "-3", "40", "1e2", "99999999999", "A" };
+        for (const char* text : texts) labels.Intern(text);
+        CHECK_EQ(labels.AlphanumericCount(), size_t(7));
+        labels.NumberLabels();
+        const int expected[] = { 41, 7, 42, 43, 44, 40, 45, 46, 47 };
+        for (uint32_t k = 0; k < 9; ++k) CHECK_EQ(labels.Number(k), expected[k]);
+        CHECK_EQ(labels.RenumberedCount(), size_t(0));
+    }
+
+    void TestTakenNumbers() {
+        LabelTable frames, cables;
+        for (const char* text : { "1", "2", "F", "10" }) frames.Intern(text);
+        for (const char* text : { "2", "C", "5", "11", "1" }) cables.Intern(text);
+        frames.NumberLabels();
+        cables.NumberLabels(&frames);
+        CHECK_EQ(frames.Number(frames.Find("F")), 11);
+        // "11" collides with the number frame "F" was given
+        CHECK_EQ(cables.Number(cables.Find("2")), 12);
+        CHECK_EQ(cables.Number(cables.Find("C")), 13);
+        CHECK_EQ(cables.Number(cables.Find("5")), 5);
+        CHECK_EQ(cables.Number(cables.Find("11")), 14);
+        CHECK_EQ(cables.Number(cables.Find("1")), 15);
+        CHECK_EQ(cables.RenumberedCount(), size_t(3));
+        CHECK_EQ(cables.AlphanumericCount(), size_t(1));
+    }
+
+    // Frame 1 and cable 1 are different objects in SAP2000
+    void TestFrameAndCableLabels() {
+        auto model = Test::LoadModel("labels.s2k",
+            "TABLE:  \"JOINT COORDINATES\"\n"
+            "   Joint=1   XorR=0   Y=0   Z=0\n"
+            "   Joint=2   XorR=0   Y=0   Z=3\n"
+            "   Joint=3   XorR=4   Y=0   Z=3\n"
+            "\n"
+            "TABLE:  \"CONNECTIVITY - FRAME\"\n"
+            "   Frame=1   JointI=1   JointJ=2\n"
+            "   Frame=2   JointI=2   JointJ=3\n"
+            "\n"
+            "TABLE:  \"CONNECTIVITY - CABLE\"\n"
+            "   Cable=1   JointI=1   JointJ=3\n"
+            "\n"
+            "TABLE:  \"GROUPS 2 - ASSIGNMENTS\"\n"
+            "   GroupName=G   ObjectType=Frame   ObjectLabel=1\n"
+            "   GroupName=G   ObjectType=Cable   ObjectLabel=1\n"
+            "\n");
+        CHECK_EQ(model->frameLabels.size(), size_t(2));
+        CHECK_EQ(model->cableLabels.size(), size_t(1));
+        if (model->beams.size() != 2 || model->cables.size() != 1) {
+            Test::Fail(__FILE__, __LINE__, "model not loaded");
+            return;
+        }
+        CHECK_EQ(model->beams[0].staadId, 1);
+        CHECK_EQ(model->cables[0].staadId, 3);
+        CHECK_EQ(model->cables[0].sapId, 0u);
+
+        // Groups point into the table of their object type
+        CHECK_EQ(model->groups.size(), size_t(2));
+        for (const auto& group : model->groups) CHECK_EQ(group.label, 0u);
+
+        // Both convert, with no issue and nothing renumbered
+        ValidationOptions options;
+        ValidationReport report;
+        CHECK(ModelValidator::Validate(*model, options, report));
+        CHECK_EQ(report.Total(), size_t(0));
+        CHECK_EQ(report.renumberedMembers, size_t(0));
+        CHECK_EQ(model->beams.size() + model->cables.size(), size_t(3));
+        set<int> numbers;
+        for (const auto& beam : model->beams) numbers.insert(beam.staadId);
+        for (const auto& cable : model->cables) numbers.insert(cable.staadId);
+        CHECK_EQ(numbers.size(), size_t(3));
+    }
+}
+
+int main() {
+    TestIntern();
+    TestNumbering();
+    TestTakenNumbers();
+    TestFrameAndCableLabels();
+    return Test::Result();
+}
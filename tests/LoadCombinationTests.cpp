@@ -0,0 +1,126 @@
+#include "TestSupport.h"
+#include "LoadCombinations.h"
+
+using namespace std;
+
+namespace {
+    const char* kPatterns =
+        "TABLE:  \"LOAD PATTERN DEFINITIONS\"\n"
+        "   LoadPat=DEAD   DesignType=Dead   SelfWtMult=1\n"
+        "   LoadPat=LIVE   DesignType=Live   SelfWtMult=0\n"
+        "\n";
+
+    string Combo(const string& name, const char* type, const char* caseType, const string& caseName, double factor) {
+        ostringstream row;
+        row << "   ComboName=" << name;
+        if (type) row << "   ComboType=\"" << type << "\"";
+        row << "   CaseType=\"" << caseType << "\"   CaseName=" << caseName << "   ScaleFactor=" << factor << "\n";
+        return row.str();
+    }
+
+    string Model() {
+        string s2k = kPatterns;
+        s2k += "TABLE:  \"COMBINATION DEFINITIONS\"\n";
+        s2k += Combo("C1", "Linear Add", "Linear Static", "DEAD", 1);
+        s2k += Combo("C1", nullptr, "Linear Static", "LIVE", 1);
+        s2k += Combo("C2", "Linear Add", "Response Combo", "C1", 2);
+        s2k += Combo("C3", "Linear Add", "Linear Static", "DEAD", 2);   // Same as C2
+        s2k += Combo("C3", nullptr, "Linear Static", "LIVE", 2);
+        s2k += Combo("ZERO", "Linear Add", "Response Combo", "C1", 1);  // Cancels out
+        s2k += Combo("ZERO", nullptr, "Linear Static", "DEAD", -1);
+        s2k += Combo("ZERO", nullptr, "Linear Static", "LIVE", -1);
+        s2k += Combo("CY1", "Linear Add", "Response Combo", "CY2", 1);
+        s2k += Combo("CY2", "Linear Add", "Response Combo", "CY1", 1);
+        s2k += Combo("T1", "Linear Add", "Response Combo", "T2", 1);
+        s2k += Combo("T2", "Linear Add", "Response Combo", "T3", 1);
+        s2k += Combo("T3", "Linear Add", "Linear Static", "DEAD", 1);
+        s2k += Combo("T3", nullptr, "Response Combo", "T1", 1);
+        s2k += Combo("ENV", "Envelope", "Response Combo", "C1", 1);
+        s2k += Combo("USES_CY", "Linear Add", "Response Combo", "CY1", 1);
+        s2k += Combo("DEEP", "Linear Add", "Response Combo", "C2", 0.5); // Nested twice
+        s2k += Combo("DEEP", nullptr, "Linear Static", "LIVE", 0.5);
+        s2k += "\n";
+        return s2k;
+    }
+
+    void TestFlatten() {
+        auto model = Test::LoadModel("combinations.s2k", Model());
+        CombinationReport report;
+        CombinationMatrix matrix = LoadCombinations::Flatten(*model, report);
+
+        CHECK_EQ(report.defined, size_t(12));
+        CHECK_EQ(report.emitted, size_t(3));
+        CHECK_EQ(report.duplicates, size_t(1));
+        CHECK_EQ(report.empty, size_t(1));
+        CHECK_EQ(report.cycles, size_t(5)); // Every member of both cycles
+        CHECK_EQ(report.unsupported, size_t(2));
+        if (matrix.Rows() != 3) return;
+
+        auto name = [&](size_t row) { return model->comboNames[matrix.combos[row]]; };
+        CHECK_EQ(name(0), string("C1"));
+        CHECK_EQ(name(1), string("C2"));
+        CHECK_EQ(name(2), string("DEEP"));
+        // DEEP = 0.5 * 2 * (DEAD + LIVE) + 0.5 LIVE
+        CHECK_EQ(matrix.offsets[3] - matrix.offsets[2], 2u);
+        CHECK_EQ(matrix.patterns[matrix.offsets[2]], 0u);
+        CHECK_NEAR(matrix.factors[matrix.offsets[2]], 1.0, 1e-12);
+        CHECK_NEAR(matrix.factors[matrix.offsets[2] + 1], 1.5, 1e-12);
+
+        // Every name maps to its row, the row of an equal one, or nothing
+        const uint32_t none = CombinationMatrix::kNoRow;
+        const uint32_t expected[] = { 0, 1, 1, none, none, none, none, none, none, none, none, 2 };
+        CHECK_EQ(matrix.rowOf.size(), size_t(12));
+        for (size_t c = 0; c < 12 && c < matrix.rowOf.size(); ++c) CHECK_EQ(matrix.rowOf[c], expected[c]);
+    }
+
+    void TestMap() {
+        auto model = Test::LoadModel("combinations_map.s2k", Model());
+        CombinationReport report;
+        CombinationMatrix matrix = LoadCombinations::Flatten(*model, report);
+        CHECK_EQ(LoadCombinations::FirstLoadNumber(model->patternNames.size()), 101L);
+        CHECK(LoadCombinations::WriteMap(*model, matrix, "combinations.csv"));
+
+        ifstream map("combinations.csv");
+        string contents((istreambuf_iterator<char>(map)), istreambuf_iterator<char>());
+        CHECK_EQ(contents, string(
+            "sap,staad,note\n"
+            "C1,101,\n"
+            "C2,102,\n"
+            "C3,102,same as C2\n"
+            "ZERO,,not created\n"
+            "CY1,,not created\n"
+            "CY2,,not created\n"
+            "T1,,not created\n"
+            "T2,,not created\n"
+            "T3,,not created\n"
+            "ENV,,not created\n"
+            "USES_CY,,not created\n"
+            "DEEP,103,\n"));
+    }
+
+    void TestDeepNesting() {
+        // Each combination nests the previous one: no recursion depth limit,
+        // and all of them flatten to the same row
+        const int depth = 100000;
+        string s2k = kPatterns;
+        s2k += "TABLE:  \"COMBINATION DEFINITIONS\"\n";
+        for (int i = depth - 1; i > 0; --i) {
+            s2k += Combo("N" + to_string(i), "Linear Add", "Response Combo", "N" + to_string(i - 1), 1);
+        }
+        s2k += Combo("N0", "Linear Add", "Linear Static", "DEAD", 1.25);
+        s2k += "\n";
+        auto model = Test::LoadModel("combinations_deep.s2k", s2k);
+        CombinationReport report;
+        CombinationMatrix matrix = LoadCombinations::Flatten(*model, report);
+        CHECK_EQ(report.emitted, size_t(1));
+        CHECK_EQ(report.duplicates, size_t(depth - 1));
+        CHECK_NEAR(matrix.factors.empty() ? 0.0 : matrix.factors[0], 1.25, 0.0);
+    }
+}
+
+int main() {
+    TestFlatten();
+    TestMap();
+    TestDeepNesting();
+    return Test::Result();
+}
@@ -0,0 +1,88 @@
+#include "TestSupport.h"
+#include "MemberOrientation.h"
+#include "UnitTransform.h"
+
+using namespace std;
+
+namespace {
+    double Beta(double dx, double dy, double dz, double sapAngle) {
+        double beta = 0.0;
+        MemberOrientation::ComputeBetas(&dx, &dy, &dz, &sapAngle, &beta, 1);
+        return beta;
+    }
+
+    void TestComputeBetas() {
+        // Non-vertical members keep the SAP angle, wrapped to [-180, 180)
+        CHECK_NEAR(Beta(5, 0, 0, 30), 30, 1e-12);
+        CHECK_NEAR(Beta(3, 4, 2, -45), -45, 1e-12);
+        CHECK_NEAR(Beta(0, 5, 0, 200), -160, 1e-12);
+        CHECK_NEAR(Beta(1, 0, 0, 180), -180, 1e-12);
+        CHECK_NEAR(Beta(1, 0, 0, 540), -180, 1e-12);
+
+        // Vertical members pointing up turn by 180 degrees, pointing down not
+        CHECK_NEAR(Beta(0, 0, 3, 0), -180, 1e-12);
+        CHECK_NEAR(Beta(0, 0, 3, 90), -90, 1e-12);
+        CHECK_NEAR(Beta(0, 0, -3, 90), 90, 1e-12);
+
+        // SAP's vertical tolerance: sine of the tilt below 1e-3
+        CHECK_NEAR(Beta(0.0009, 0, 1, 0), -180, 1e-12);
+        CHECK_NEAR(Beta(0.0011, 0, 1, 0), 0, 1e-12);
+
+        // Zero-length members are left to the validator
+        CHECK_NEAR(Beta(0, 0, 0, 15), 15, 1e-12);
+
+        // The kernel runs on plain arrays
+        const double dx[] = { 1, 0, 0 }, dy[] = { 0, 0, 0 }, dz[] = { 0, 1, -1 };
+        const double angle[] = { 10, 10, 10 };
+        double beta[3] = {};
+        MemberOrientation::ComputeBetas(dx, dy, dz, angle, beta, 3);
+        CHECK_NEAR(beta[0], 10, 1e-12);
+        CHECK_NEAR(beta[1], -170, 1e-12);
+        CHECK_NEAR(beta[2], 10, 1e-12);
+    }
+
+    const char* kModel =
+        "TABLE:  \"JOINT COORDINATES\"\n"
+        "   Joint=1   XorR=0   Y=0   Z=0\n"
+        "   Joint=2   XorR=0   Y=0   Z=3\n"
+        "   Joint=3   XorR=5   Y=0   Z=3\n"
+        "\n"
+        "TABLE:  \"FRAME LOCAL AXES ASSIGNMENTS 1 - TYPICAL\"\n"
+        "   Frame=2   Angle=30   AdvanceAxes=No\n"
+        "   Frame=3   Angle=90   AdvanceAxes=Yes\n"
+        "\n"
+        "TABLE:  \"CONNECTIVITY - FRAME\"\n"
+        "   Frame=1   JointI=1   JointJ=2\n"
+        "   Frame=2   JointI=2   JointJ=3\n"
+        "   Frame=3   JointI=3   JointJ=1\n"
+        "   Frame=4   JointI=3   JointJ=99\n"
+        "\n";
+
+    void TestApplyInBothAxes() {
+        auto zUp = Test::LoadModel("orientation.s2k", kModel);
+        OrientationReport report = MemberOrientation::Apply(*zUp);
+        CHECK_EQ(report.vertical, size_t(1));
+        CHECK_EQ(report.advancedAxes, size_t(1));
+        CHECK_EQ(report.rotated, size_t(3));
+        CHECK_EQ(report.betaGroups, size_t(3));
+
+        // Same betas after the Y-up remap
+        auto yUp = Test::LoadModel("orientation_yup.s2k", kModel);
+        TransformOptions options;
+        options.targetUp = UpAxis::Y;
+        CHECK(UnitTransform::Apply(*yUp, options));
+        MemberOrientation::Apply(*yUp);
+
+        const double expected[] = { -180, 30, 90, 0 };
+        for (size_t k = 0; k < 4; ++k) {
+            CHECK_NEAR(zUp->beams[k].beta, expected[k], 1e-12);
+            CHECK_NEAR(yUp->beams[k].beta, expected[k], 1e-12);
+        }
+    }
+}
+
+int main() {
+    TestComputeBetas();
+    TestApplyInBothAxes();
+    return Test::Result();
+}
@@ -0,0 +1,98 @@
+#include "TestSupport.h"
+#include "SAP2000Parser.h"
+
+using namespace std;
+
+namespace {
+    const char* kJoints =
+        "TABLE:  \"JOINT COORDINATES\"\n"
+        "   Joint=1   CoordSys=GLOBAL   XorR=0   Y=0   Z=0\n"
+        "   Joint=A12   CoordSys=GLOBAL   XorR=+2.5   Y=0   Z=3\n"
+        "   Joint=3   CoordSys=GLOBAL   XorR=abc   Y=0   Z=0\n"
+        "   Joint=4   CoordSys=GLOBAL   XorR=0   Y=1e999   Z=0\n"
+        "   Joint=5   CoordSys=GLOBAL   XorR=0   Y=0   Z=3m\n"
+        "   CoordSys=GLOBAL   XorR=0   Y=0   Z=0\n"
+        "   Joint=   CoordSys=GLOBAL   XorR=0   Y=0   Z=0\n"
+        "   Joint=\"Tower 1\"   CoordSys=GLOBAL   XorR=7   Y=0   Z=0\n"
+        "\n";
+
+    void TestRowErrorClassification() {
+        InputText text;
+        CHECK(text.Load(Test::WriteFile("parser_rows.s2k", kJoints)));
+        SectionPositions positions = SAP2000Parser::ParseFile(text);
+        CHECK_EQ(positions.ijoint, 1L);
+        CHECK_EQ(positions.rows.joint, size_t(8));
+        // Rows start right after the 28-byte header line
+        CHECK_EQ(positions.offsets.size(), size_t(1));
+        CHECK(!positions.offsets.empty() && positions.offsets[0] == make_pair(2L, uint64_t(28)));
+
+        LabelTable labels;
+        ParseErrorLog errors;
+        auto nodes = SAP2000Parser::ExtractNodes(text, positions.ijoint + 1, labels,
+            positions.rows.joint, pmr::get_default_resource(), &errors);
+
+        CHECK_EQ(nodes.size(), size_t(3));
+        CHECK_EQ(errors.Total(), size_t(5));
+        if (nodes.size() == 3) {
+            CHECK_EQ(labels.Text(nodes[1].sapId), string_view("A12"));
+            CHECK_NEAR(nodes[1].x, 2.5, 0.0);
+            CHECK_EQ(labels.Text(nodes[2].sapId), string_view("Tower 1"));
+        }
+        // Rows dropped for a bad coordinate leave no label behind
+        CHECK(labels.Find("3") == LabelTable::kNone);
+
+        ostringstream summary;
+        errors.PrintSummary(summary);
+        CHECK_EQ(summary.str(), string("  JOINT COORDINATES: 5 malformed field(s), 2 missing field, "
+            "1 not a number, 1 out of range, 1 trailing characters\n"));
+    }
+
+    void TestErrorReport() {
+        InputText text;
+        CHECK(text.Load(Test::WriteFile("parser_report.s2k", kJoints)));
+        LabelTable labels;
+        ParseErrorLog errors(2);
+        SAP2000Parser::ExtractNodes(text, 2, labels, 0, pmr::get_default_resource(), &errors);
+        CHECK(errors.WriteReport("parser_report.txt"));
+
+        ifstream report("parser_report.txt");
+        string contents((istreambuf_iterator<char>(report)), istreambuf_iterator<char>());
+        CHECK(contents.find("line 4, col 37, XorR: not a number\n") != string::npos);
+        CHECK(contents.find("line 5, col 43, Y: out of range\n") != string::npos);
+        // Capped at two entries per table
+        CHECK(contents.find("... 3 more not listed\n") != string::npos);
+    }
+
+    // A CRLF blank line ends the restraint table: the spring rows after it
+    // must neither become restraints nor be reported as malformed
+    void TestRestraintTableEnd() {
+        InputText text;
+        CHECK(text.Load(Test::WriteFile("parser_restraints.s2k",
+            "TABLE:  \"JOINT RESTRAINT ASSIGNMENTS\"\r\n"
+            "   Joint=1   U1=Yes   U2=Yes   U3=Yes   R1=No   R2=No   R3=No\r\n"
+            "   Joint=2   U1=Yes   U2=Yes   U3=Yes   R1=Yes   R2=Yes   R3=Yes\r\n"
+            "\r\n"
+            "TABLE:  \"JOINT SPRING ASSIGNMENTS 1 - UNCOUPLED\"\r\n"
+            "   Joint=1   CoordSys=Local   U1=0   U2=0   U3=1000   R1=0   R2=0   R3=0\r\n"
+            "   Joint=3   CoordSys=Local   U1=0   U2=0   U3=1000   R1=0   R2=0   R3=0\r\n"
+            "\r\n")));
+        LabelTable labels;
+        ParseErrorLog errors;
+        auto restraints = SAP2000Parser::ExtractJointRestraints(text, 2, labels, 0,
+            pmr::get_default_resource(), &errors);
+        CHECK_EQ(restraints.size(), size_t(2));
+        CHECK_EQ(errors.Total(), size_t(0));
+        CHECK(labels.Find("3") == LabelTable::kNone);
+        if (restraints.size() == 2) {
+            CHECK(restraints[0].U3 && !restraints[0].R1);
+            CHECK(restraints[1].R3);
+        }
+    }
+}
+
+int main() {
+    TestRowErrorClassification();
+    TestErrorReport();
+    TestRestraintTableEnd();
+    return Test::Result();
+}
@@ -0,0 +1,75 @@
+#include "TestSupport.h"
+#include "Renumbering.h"
+#include <algorithm>
+#include <cstdlib>
+
+using namespace std;
+
+namespace {
+    const int kChain = 30;
+
+    // A straight chain of joints whose labels jump around (7 is coprime with
+    // 30), plus a frame to a joint that does not exist
+    string ScrambledChain() {
+        ostringstream s2k;
+        s2k << "TABLE:  \"JOINT COORDINATES\"\n";
+        for (int i = 0; i < kChain; ++i) {
+            s2k << "   Joint=" << (i * 7) % kChain + 1 << "   XorR=" << i << "   Y=0   Z=0\n";
+        }
+        s2k << "\nTABLE:  \"CONNECTIVITY - FRAME\"\n";
+        for (int i = 0; i + 1 < kChain; ++i) {
+            s2k << "   Frame=" << i + 1 << "   JointI=" << (i * 7) % kChain + 1
+                << "   JointJ=" << ((i + 1) * 7) % kChain + 1 << "\n";
+        }
+        s2k << "   Frame=" << kChain << "   JointI=1   JointJ=999\n\n";
+        return s2k.str();
+    }
+
+    void TestChainBandwidth() {
+        auto model = Test::LoadModel("renumbering.s2k", ScrambledChain());
+        CHECK_EQ(model->nodes.size(), size_t(kChain));
+        RenumberReport report = Renumbering::Apply(*model);
+
+        CHECK(report.bandwidthBefore > 1);
+        CHECK_EQ(report.bandwidthAfter, size_t(1));
+        CHECK(report.profileAfter < report.profileBefore);
+
+        // Joints along the chain get consecutive numbers, in either direction
+        for (int i = 0; i + 1 < kChain; ++i) {
+            CHECK_EQ(abs(model->nodes[i].staadId - model->nodes[i + 1].staadId), 1);
+        }
+        vector<int> joints, members;
+        for (const auto& node : model->nodes) joints.push_back(node.staadId);
+        for (const auto& beam : model->beams) members.push_back(beam.staadId);
+        sort(joints.begin(), joints.end());
+        sort(members.begin(), members.end());
+        for (int i = 0; i < kChain; ++i) {
+            CHECK_EQ(joints[i], i + 1);
+            CHECK_EQ(members[i], i + 1);
+        }
+    }
+
+    void TestMap() {
+        auto model = Test::LoadModel("renumbering_map.s2k", ScrambledChain());
+        Renumbering::Apply(*model, false);
+        CHECK(Renumbering::WriteMap(*model, "renumbering.csv"));
+
+        ifstream map("renumbering.csv");
+        string line;
+        getline(map, line);
+        CHECK_EQ(line, string("kind,sap,staad"));
+        size_t joints = 0, frames = 0;
+        while (getline(map, line)) {
+            if (line.compare(0, 6, "joint,") == 0) joints++;
+            if (line.compare(0, 6, "frame,") == 0) frames++;
+        }
+        CHECK_EQ(joints, size_t(kChain));
+        CHECK_EQ(frames, size_t(kChain));
+    }
+}
+
+int main() {
+    TestChainBandwidth();
+    TestMap();
+    return Test::Result();
+}
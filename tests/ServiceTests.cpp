@@ -0,0 +1,175 @@
+#include "TestSupport.h"
+#include "ConversionService.h"
+#include "StdFileBackend.h"
+#include <condition_variable>
+#include <map>
+#include <mutex>
+#include <thread>
+#include <vector>
+#ifndef _WIN32
+#include <sys/stat.h>
+#endif
+
+using namespace std;
+
+namespace {
+#ifdef _WIN32
+    const char* kEndpoint = "sap2staad_service_tests";
+#else
+    const char* kEndpoint = "./service_tests.sock";
+#endif
+
+    const char* kModel =
+        "TABLE:  \"JOINT COORDINATES\"\n"
+        "   Joint=1   XorR=0   Y=0   Z=0\n"
+        "   Joint=2   XorR=0   Y=0   Z=3\n"
+        "\n"
+        "TABLE:  \"CONNECTIVITY - FRAME\"\n"
+        "   Frame=1   JointI=1   JointJ=2\n"
+        "\n";
+
+    // Holds the first model until released, so the next jobs queue up
+    // behind a running one and their order depends only on priority
+    class GatedBackend : public StdFileBackend {
+    public:
+        bool NewModel(const string& stdPath, const UnitSystem& units, UpAxis up) override {
+            unique_lock<mutex> lock(mutex_);
+            open_.wait(lock, [this] { return released_; });
+            return StdFileBackend::NewModel(stdPath, units, up);
+        }
+        void Release() {
+            lock_guard<mutex> lock(mutex_);
+            released_ = true;
+            open_.notify_all();
+        }
+    private:
+        mutex mutex_;
+        condition_variable open_;
+        bool released_ = false;
+    };
+
+    vector<string> Fields(const string& line) {
+        vector<string> fields;
+        istringstream in(line);
+        string field;
+        while (getline(in, field, '\t')) fields.push_back(field);
+        return fields;
+    }
+
+    string Job(const string& input, int priority) {
+        return "JOB\t--model-units\t4\t5\t--output-dir\tservice_out\t--priority\t" +
+            to_string(priority) + "\t" + input;
+    }
+
+    void TestQueueOrder() {
+        Test::WriteFile("service_a.s2k", kModel);
+        Test::WriteFile("service_low.s2k", kModel);
+        Test::WriteFile("service_high.s2k", kModel);
+
+        GatedBackend backend;
+        ConversionService service(backend, kEndpoint);
+        int exitCode = -1;
+        thread server([&] { exitCode = service.Run(); });
+
+        unique_ptr<LocalConnection> client;
+        for (int attempt = 0; attempt < 200 && !client; ++attempt) {
+            this_thread::sleep_for(chrono::milliseconds(10));
+            client = LocalChannel::Connect(kEndpoint);
+        }
+        CHECK(client != nullptr);
+        if (!client) {
+            backend.Release();
+            server.join();
+            return;
+        }
+#ifndef _WIN32
+        struct stat info;
+        CHECK(stat(LocalChannel::Address(kEndpoint).c_str(), &info) == 0);
+        CHECK_EQ(info.st_mode & (S_IRWXG | S_IRWXO), 0u);
+#endif
+
+        // The first job starts and blocks; the next two queue behind it
+        CHECK(client->WriteLine(Job("service_a.s2k", 0)));
+        string line;
+        vector<vector<string>> replies;
+        while (client->ReadLine(line)) {
+            replies.push_back(Fields(line));
+            if (replies.back()[0] == "STARTED") break;
+        }
+        CHECK(client->WriteLine(Job("service_low.s2k", 1)));
+        CHECK(client->WriteLine(Job("service_high.s2k", 5)));
+        CHECK(client->WriteLine(Job("service_missing.s2k", 0)));
+
+        // QUEUED replies arrive before anything else once the first job waits
+        for (int k = 0; k < 3 && client->ReadLine(line); ++k) replies.push_back(Fields(line));
+        backend.Release();
+
+        size_t finished = 0;
+        while (finished < 4 && client->ReadLine(line)) {
+            replies.push_back(Fields(line));
+            const string& kind = replies.back()[0];
+            if (kind == "DONE" || kind == "FAILED") ++finished;
+        }
+        CHECK_EQ(finished, size_t(4));
+
+        // Job ids are 1 to 4 in submission order
+        vector<string> sequence;
+        map<string, vector<string>> byJob;
+        for (const auto& reply : replies) {
+            if (reply.size() < 2) continue;
+            if (reply[0] == "METRIC") continue;
+            byJob[reply[1]].push_back(reply[0]);
+            if (reply[0] != "PROGRESS") sequence.push_back(reply[0] + " " + reply[1]);
+        }
+        vector<string> expected = {
+            "QUEUED 1", "STARTED 1",
+            "QUEUED 2", "QUEUED 3", "QUEUED 4",
+            "DONE 1",
+            "STARTED 3", "DONE 3",
+            "STARTED 2", "DONE 2",
+            "STARTED 4", "FAILED 4"
+        };
+        CHECK_EQ(sequence.size(), expected.size());
+        for (size_t k = 0; k < min(sequence.size(), expected.size()); ++k) CHECK_EQ(sequence[k], expected[k]);
+
+        // Jobs queued behind others say how many run first
+        for (const auto& reply : replies) {
+            if (reply[0] != "QUEUED") continue;
+            if (reply[1] == "2") CHECK_EQ(reply[2], string("1"));
+            if (reply[1] == "3") CHECK_EQ(reply[2], string("1"));
+            if (reply[1] == "4") CHECK_EQ(reply[2], string("3"));
+        }
+
+        // Every converted job reports progress between STARTED and DONE
+        for (const string id : { "1", "2", "3" }) {
+            const auto& kinds = byJob[id];
+            CHECK(kinds.size() > 3);
+            if (kinds.size() > 3) {
+                CHECK_EQ(kinds[1], string("STARTED"));
+                CHECK_EQ(kinds[2], string("PROGRESS"));
+                CHECK_EQ(kinds[kinds.size() - 2], string("PROGRESS"));
+                CHECK_EQ(kinds.back(), string("DONE"));
+            }
+        }
+        ifstream converted("service_out/service_high.std");
+        CHECK(converted.is_open());
+
+        CHECK(client->WriteLine("STATUS"));
+        CHECK(client->ReadLine(line));
+        CHECK_EQ(line, string("STATUS\t0\t0\t3\t1"));
+
+        CHECK(client->WriteLine("SHUTDOWN"));
+        CHECK(client->ReadLine(line));
+        CHECK_EQ(line, string("BYE"));
+        server.join();
+        CHECK_EQ(exitCode, 0);
+        // The connection is closed once the service has stopped
+        CHECK(!client->ReadLine(line));
+        CHECK(LocalChannel::Connect(kEndpoint) == nullptr);
+    }
+}
+
+int main() {
+    TestQueueOrder();
+    return Test::Result();
+}
@@ -0,0 +1,146 @@
+#include "TestSupport.h"
+#include "StdFileBackend.h"
+#include "SupportSpec.h"
+#include <map>
+
+using namespace std;
+
+namespace {
+    const char* kDofNames[6] = { "FX", "FY", "FZ", "MX", "MY", "MZ" };
+
+    // The support text the file backend should write for what the COM
+    // backend is given: the kind and the released DOFs
+    string ExpectedText(uint8_t key, const double* stiffness) {
+        double released[6];
+        switch (SupportSpec::Describe(key, stiffness, released)) {
+        case SupportSpec::Kind::None: return string();
+        case SupportSpec::Kind::Fixed: return "FIXED";
+        case SupportSpec::Kind::Pinned: return "PINNED";
+        default: break;
+        }
+        string text = "FIXED BUT";
+        for (int i = 0; i < 6; ++i) {
+            if (released[i] != 0.0) text += string(" ") + kDofNames[i];
+        }
+        for (int i = 0; i < 6; ++i) {
+            if (stiffness && stiffness[i] != 0.0) text += string(" K") + kDofNames[i] + " 1000";
+        }
+        return text;
+    }
+
+    // SUPPORTS lines of a .std file by STAAD node number
+    map<long, string> ReadSupports(const string& path) {
+        ifstream file(path);
+        map<long, string> supports;
+        string line;
+        bool inSupports = false;
+        while (getline(file, line)) {
+            if (line == "SUPPORTS") {
+                inSupports = true;
+                continue;
+            }
+            if (!inSupports || line.empty() || !isdigit(static_cast<unsigned char>(line[0]))) {
+                inSupports = false;
+                continue;
+            }
+            istringstream tokens(line);
+            vector<long> ids;
+            string token;
+            while (tokens >> token) {
+                if (token == "TO") {
+                    long last = 0;
+                    tokens >> last;
+                    for (long id = ids.back() + 1; id <= last; ++id) ids.push_back(id);
+                }
+                else if (isdigit(static_cast<unsigned char>(token[0]))) {
+                    ids.push_back(stol(token));
+                }
+                else {
+                    break;
+                }
+            }
+            string spec = token;
+            while (tokens >> token) spec += " " + token;
+            for (long id : ids) supports[id] = spec;
+        }
+        return supports;
+    }
+
+    void TestReleases() {
+        // A restrained DOF is never released, a free one always is
+        for (int key = 0; key < 64; ++key) {
+            double released[6];
+            SupportSpec::Describe(static_cast<uint8_t>(key), nullptr, released);
+            for (int i = 0; i < 6; ++i) CHECK_EQ(released[i], ((key >> i) & 1) ? 0.0 : 1.0);
+        }
+        double released[6];
+        CHECK(SupportSpec::Describe(0, nullptr, released) == SupportSpec::Kind::None);
+        CHECK(SupportSpec::Describe(7, nullptr, released) == SupportSpec::Kind::Pinned);
+        CHECK(SupportSpec::Describe(63, nullptr, released) == SupportSpec::Kind::Fixed);
+        CHECK(SupportSpec::Describe(5, nullptr, released) == SupportSpec::Kind::FixedBut);
+
+        // A sprung DOF is not released either
+        const double spring[6] = { 0, 0, 1000, 0, 0, 0 };
+        CHECK(SupportSpec::Describe(0, spring, released) == SupportSpec::Kind::FixedBut);
+        CHECK_EQ(released[2], 0.0);
+        CHECK_EQ(released[0], 1.0);
+    }
+
+    // Every DOF key, and a spring, as the file backend writes them
+    void TestFileBackendMatches() {
+        ModelVector<Node> nodes;
+        ModelVector<JointRestraint> restraints;
+        ModelVector<JointSpring> springs;
+        for (uint32_t k = 0; k < 66; ++k) {
+            Node node;
+            node.sapId = k;
+            node.x = k;
+            node.staadId = static_cast<int>(k) + 1;
+            nodes.push_back(node);
+        }
+        for (uint32_t k = 0; k < 64; ++k) {
+            JointRestraint r = { k, (k & 1) != 0, (k & 2) != 0, (k & 4) != 0,
+                (k & 8) != 0, (k & 16) != 0, (k & 32) != 0 };
+            CHECK_EQ(SupportSpec::DofKey(r), uint8_t(k));
+            restraints.push_back(r);
+        }
+        // Joint 64: pinned with a vertical spring; joint 65: only a spring
+        restraints.push_back(JointRestraint{ 64, true, true, true, false, false, false });
+        JointSpring spring;
+        spring.jointId = 64;
+        spring.U3 = 1000;
+        springs.push_back(spring);
+        spring.jointId = 65;
+        springs.push_back(spring);
+
+        UnitSystem units;
+        units.lengthUnit = 4;
+        units.forceUnit = 5;
+        StdFileBackend backend;
+        CHECK(backend.NewModel("supports.std", units, UpAxis::Y));
+        CHECK(backend.CreateNodes(nodes));
+        CHECK(backend.CreateSupports(restraints, springs));
+        CHECK(backend.Save());
+
+        map<long, string> written = ReadSupports("supports.std");
+        CHECK(written.find(1) == written.end()); // Key 0: no support
+        const double stiffness[6] = { 0, 0, 1000, 0, 0, 0 };
+        for (int k = 0; k < 66; ++k) {
+            string expected = k < 64 ? ExpectedText(static_cast<uint8_t>(k), nullptr)
+                : ExpectedText(k == 64 ? 7 : 0, stiffness);
+            auto it = written.find(k + 1);
+            string found = it == written.end() ? string() : it->second;
+            CHECK_EQ(found, expected);
+        }
+        CHECK_EQ(written[8], string("PINNED"));
+        CHECK_EQ(written[64], string("FIXED"));
+        CHECK_EQ(written[6], string("FIXED BUT FY MX MY MZ")); // Key 5: U1 and U3 restrained
+        CHECK_EQ(written[65], string("FIXED BUT MX MY MZ KFZ 1000"));
+    }
+}
+
+int main() {
+    TestReleases();
+    TestFileBackendMatches();
+    return Test::Result();
+}
@@ -0,0 +1,69 @@
+#pragma once
+#include <cmath>
+#include <fstream>
+#include <iostream>
+#include <memory>
+#include <sstream>
+#include <string>
+#include "InputStream.h"
+#include "SAP2000Model.h"
+
+// Minimal checks for the stage tests: a failed check prints where and keeps
+// going, and main() returns Test::Result() so ctest sees the failure.
+namespace Test {
+    inline int& Failures() {
+        static int failures = 0;
+        return failures;
+    }
+
+    inline int Result() {
+        if (Failures() > 0) std::cerr << Failures() << " check(s) failed" << std::endl;
+        return Failures() > 0 ? 1 : 0;
+    }
+
+    inline void Fail(const char* file, int line, const std::string& what) {
+        std::cerr << file << ":" << line << ": " << what << std::endl;
+        Failures()++;
+    }
+
+    // Writes a fixture into the working directory and returns its path
+    inline std::string WriteFile(const std::string& name, const std::string& contents) {
+        std::ofstream file(name, std::ios::binary);
+        file << contents;
+        return name;
+    }
+
+    // Parses an .s2k text the way the pipeline does
+    inline std::unique_ptr<SAP2000Model> LoadModel(const std::string& name, const std::string& s2k) {
+        InputText text;
+        text.Load(WriteFile(name, s2k));
+        auto model = std::make_unique<SAP2000Model>(SAP2000Parser::ParseFile(text));
+        model->Load(text);
+        return model;
+    }
+}
+
+#define CHECK(condition) \
+    do { if (!(condition)) Test::Fail(__FILE__, __LINE__, "CHECK(" #condition ")"); } while (0)
+
+#define CHECK_EQ(actual, expected) \
+    do { \
+        const auto& actual_ = (actual); \
+        const auto& expected_ = (expected); \
+        if (!(actual_ == expected_)) { \
+            std::ostringstream message_; \
+            message_ << #actual " == " << actual_ << ", expected " << expected_; \
+            Test::Fail(__FILE__, __LINE__, message_.str()); \
+        } \
+    } while (0)
+
+#define CHECK_NEAR(actual, expected, tolerance) \
+    do { \
+        double actual_ = (actual); \
+        double expected_ = (expected); \
+        if (!(std::fabs(actual_ - expected_) <= (tolerance))) { \
+            std::ostringstream message_; \
+            message_ << #actual " == " << actual_ << ", expected " << expected_; \
+            Test::Fail(__FILE__, __LINE__, message_.str()); \
+        } \
+    } while (0)
@@ -0,0 +1,61 @@
+#include "TestSupport.h"
+#include "UnitTransform.h"
+#include "Parallel.h"
+
+using namespace std;
+
+namespace {
+    CoordinateArrays MakeCoordinates(size_t count) {
+        CoordinateArrays coordinates(pmr::new_delete_resource());
+        for (size_t i = 0; i < count; ++i) {
+            coordinates.x.push_back(0.1 * static_cast<double>(i));
+            coordinates.y.push_back(1.0 / (1.0 + static_cast<double>(i % 977)));
+            coordinates.z.push_back(-3.7 * static_cast<double>(i % 131));
+        }
+        return coordinates;
+    }
+
+    void TestAxisRemap() {
+        CoordinateArrays coordinates(pmr::new_delete_resource());
+        coordinates.x = { 1.0 };
+        coordinates.y = { 2.0 };
+        coordinates.z = { 3.0 };
+
+        // Z-up (x, y, z) -> Y-up (x, z, -y), here also mm -> m
+        UnitTransform::TransformCoordinates(coordinates, 0.001, UpAxis::Z, UpAxis::Y);
+        CHECK_NEAR(coordinates.x[0], 0.001, 1e-15);
+        CHECK_NEAR(coordinates.y[0], 0.003, 1e-15);
+        CHECK_NEAR(coordinates.z[0], -0.002, 1e-15);
+
+        UnitTransform::TransformCoordinates(coordinates, 1000.0, UpAxis::Y, UpAxis::Z);
+        CHECK_NEAR(coordinates.x[0], 1.0, 1e-12);
+        CHECK_NEAR(coordinates.y[0], 2.0, 1e-12);
+        CHECK_NEAR(coordinates.z[0], 3.0, 1e-12);
+
+        // Same axes and units leaves the arrays alone
+        UnitTransform::TransformCoordinates(coordinates, 1.0, UpAxis::Z, UpAxis::Z);
+        CHECK_NEAR(coordinates.y[0], 2.0, 1e-12);
+    }
+
+    void TestParallelMatchesSerial() {
+        // Large enough for Parallel::For to split into several workers
+        const size_t count = 4 * Parallel::kMinChunk + 17;
+        CoordinateArrays serial = MakeCoordinates(count);
+        CoordinateArrays parallel = MakeCoordinates(count);
+
+        UnitTransform::TransformCoordinates(serial, 0.3048, UpAxis::Z, UpAxis::Y, false);
+        UnitTransform::TransformCoordinates(parallel, 0.3048, UpAxis::Z, UpAxis::Y, true);
+
+        CHECK(serial.x == parallel.x);
+        CHECK(serial.y == parallel.y);
+        CHECK(serial.z == parallel.z);
+        CHECK_NEAR(parallel.y[count - 1], 0.3048 * -3.7 * static_cast<double>((count - 1) % 131), 1e-9);
+        CHECK_NEAR(parallel.z[count - 1], -0.3048 / (1.0 + static_cast<double>((count - 1) % 977)), 1e-12);
+    }
+}
+
+int main() {
+    TestAxisRemap();
+    TestParallelMatchesSerial();
+    return Test::Result();
+}
@@ -0,0 +1,119 @@
+#include "TestSupport.h"
+#include "ModelValidator.h"
+#include <algorithm>
+
+using namespace std;
+
+namespace {
+    const char* kModel =
+        "TABLE:  \"JOINT COORDINATES\"\n"
+        "   Joint=1   XorR=0   Y=0   Z=0\n"
+        "   Joint=2   XorR=0   Y=0   Z=3\n"
+        "   Joint=3   XorR=5   Y=0   Z=3\n"
+        "   Joint=4   XorR=5   Y=0   Z=0\n"
+        "\n"
+        "TABLE:  \"JOINT RESTRAINT ASSIGNMENTS\"\n"
+        "   Joint=1   U1=Yes   U2=Yes   U3=Yes   R1=Yes   R2=Yes   R3=Yes\n"
+        "   Joint=77   U1=Yes   U2=Yes   U3=Yes   R1=No   R2=No   R3=No\n"
+        "\n"
+        "TABLE:  \"CONNECTIVITY - FRAME\"\n"
+        "   Frame=1   JointI=1   JointJ=2\n"
+        "   Frame=2   JointI=2   JointJ=3\n"
+        "   Frame=3   JointI=3   JointJ=4\n"
+        "   Frame=2   JointI=1   JointJ=3\n"
+        "   Frame=5   JointI=4   JointJ=99\n"
+        "\n"
+        "TABLE:  \"CONNECTIVITY - CABLE\"\n"
+        "   Cable=1   JointI=2   JointJ=4\n"
+        "\n";
+
+    size_t Count(const ValidationReport& report, IssueKind kind) {
+        return report.counts[static_cast<size_t>(kind)];
+    }
+
+    // Gives the cable the STAAD number of frame 1, as if both had been numbered together
+    unique_ptr<SAP2000Model> LoadClashingModel() {
+        auto model = Test::LoadModel("validator.s2k", kModel);
+        if (!model->cables.empty()) model->cables[0].staadId = model->beams[0].staadId;
+        return model;
+    }
+
+    void TestDropPolicy() {
+        auto model = LoadClashingModel();
+        ValidationOptions options;
+        ValidationReport report;
+        CHECK(ModelValidator::Validate(*model, options, report));
+
+        CHECK_EQ(Count(report, IssueKind::DuplicateMemberId), size_t(1));
+        CHECK_EQ(Count(report, IssueKind::MissingJoint), size_t(1));
+        CHECK_EQ(Count(report, IssueKind::UnknownSupportJoint), size_t(1));
+        CHECK_EQ(report.droppedMembers, size_t(2));
+        CHECK_EQ(report.droppedSupports, size_t(1));
+
+        // The frame/cable clash is renumbered, not dropped
+        CHECK_EQ(report.renumberedMembers, size_t(1));
+        CHECK_EQ(model->beams.size(), size_t(3));
+        CHECK_EQ(model->cables.size(), size_t(1));
+        if (model->cables.size() == 1) {
+            int cableId = model->cables[0].staadId;
+            for (const auto& beam : model->beams) CHECK(beam.staadId < cableId);
+        }
+
+        ostringstream summary;
+        report.PrintSummary(summary);
+        CHECK(summary.str().find("  2 member(s) dropped\n  1 support(s) dropped\n") != string::npos);
+    }
+
+    void TestFixPolicy() {
+        auto model = LoadClashingModel();
+        ValidationOptions options;
+        options.policy = ValidationPolicy::Fix;
+        ValidationReport report;
+        CHECK(ModelValidator::Validate(*model, options, report));
+
+        // The repeated frame 2 is kept with a fresh number as well
+        CHECK_EQ(report.renumberedMembers, size_t(2));
+        CHECK_EQ(report.droppedMembers, size_t(1));
+        CHECK_EQ(model->beams.size(), size_t(4));
+        vector<int> ids;
+        for (const auto& beam : model->beams) ids.push_back(beam.staadId);
+        for (const auto& cable : model->cables) ids.push_back(cable.staadId);
+        sort(ids.begin(), ids.end());
+        CHECK(adjacent_find(ids.begin(), ids.end()) == ids.end());
+    }
+
+    void TestAbortPolicy() {
+        auto model = LoadClashingModel();
+        ValidationOptions options;
+        options.policy = ValidationPolicy::Abort;
+        ValidationReport report;
+        CHECK(!ModelValidator::Validate(*model, options, report));
+
+        // A clash alone is not an error in the model
+        auto clean = Test::LoadModel("validator_clean.s2k",
+            "TABLE:  \"JOINT COORDINATES\"\n"
+            "   Joint=1   XorR=0   Y=0   Z=0\n"
+            "   Joint=2   XorR=0   Y=0   Z=3\n"
+            "   Joint=3   XorR=5   Y=0   Z=3\n"
+            "\n"
+            "TABLE:  \"CONNECTIVITY - FRAME\"\n"
+            "   Frame=1   JointI=1   JointJ=2\n"
+            "\n"
+            "TABLE:  \"CONNECTIVITY - CABLE\"\n"
+            "   Cable=1   JointI=2   JointJ=3\n"
+            "\n");
+        clean->cables[0].staadId = clean->beams[0].staadId;
+        ValidationReport cleanReport;
+        CHECK(ModelValidator::Validate(*clean, options, cleanReport));
+        CHECK_EQ(cleanReport.Total(), size_t(0));
+        CHECK_EQ(cleanReport.renumberedMembers, size_t(1));
+        CHECK(clean->cables[0].staadId != clean->beams[0].staadId);
+    }
+}
+
+int main() {
+    TestDropPolicy();
+    TestFixPolicy();
+    TestAbortPolicy();
+    return Test::Result();
+}
@@ -0,0 +1,116 @@
+#include "TestSupport.h"
+#include "ModelVerifier.h"
+#include "StdFileBackend.h"
+
+using namespace std;
+
+namespace {
+    const char* kModel =
+        "TABLE:  \"JOINT COORDINATES\"\n"
+        "   Joint=1   XorR=0   Y=0   Z=0\n"
+        "   Joint=2   XorR=0   Y=0   Z=3.25\n"
+        "   Joint=A3   XorR=-5.5   Y=0.1   Z=3.25\n"
+        "\n"
+        "TABLE:  \"CONNECTIVITY - FRAME\"\n"
+        "   Frame=1   JointI=1   JointJ=2\n"
+        "   Frame=2   JointI=2   JointJ=A3\n"
+        "\n"
+        "TABLE:  \"CONNECTIVITY - CABLE\"\n"
+        "   Cable=7   JointI=1   JointJ=A3\n"
+        "\n";
+
+    size_t Count(const VerificationReport& report, MismatchKind kind) {
+        return report.counts[static_cast<size_t>(kind)];
+    }
+
+    void TestReadStdFile() {
+        // CRLF endings, comments, several entries per line, continuations,
+        // a malformed entry and blocks that are not geometry
+        Test::WriteFile("verifier_read.std",
+            "STAAD SPACE\r\n"
+            "* Comment 1 2 3;\r\n"
+            "UNIT METER KN\r\n"
+            "JOINT COORDINATES\r\n"
+            "1 0 0 0; 2 0 3.25 0;\r\n"
+            "3 -5.5 3.25 -\r\n"
+            "  1e-3; 4 abc 0 0;\r\n"
+            "MEMBER INCIDENCES\r\n"
+            "1 1 2; 2 2 -\r\n"
+            "3;\r\n"
+            "3 1 3;\r\n"
+            "SUPPORTS\r\n"
+            "1 2 FIXED\r\n"
+            "FINISH\r\n");
+        StdGeometry geometry;
+        CHECK(ModelVerifier::ReadStdFile("verifier_read.std", geometry));
+        CHECK(geometry.nodeIds == vector<int>({ 1, 2, 3 }));
+        CHECK(geometry.x == vector<double>({ 0, 0, -5.5 }));
+        CHECK(geometry.y == vector<double>({ 0, 3.25, 3.25 }));
+        CHECK(geometry.z == vector<double>({ 0, 0, 1e-3 }));
+        CHECK(geometry.memberIds == vector<int>({ 1, 2, 3 }));
+        CHECK(geometry.startNodes == vector<int>({ 1, 2, 1 }));
+        CHECK(geometry.endNodes == vector<int>({ 2, 3, 3 }));
+
+        StdGeometry missing;
+        CHECK(!ModelVerifier::ReadStdFile("verifier_missing.std", missing));
+    }
+
+    // What the file backend writes reads back to the same model
+    void TestRoundTrip() {
+        auto model = Test::LoadModel("verifier.s2k", kModel);
+        UnitSystem units;
+        units.lengthUnit = 4;
+        units.forceUnit = 5;
+        StdFileBackend backend;
+        CHECK(backend.NewModel("verifier_roundtrip.std", units, UpAxis::Z));
+        CHECK(backend.CreateNodes(model->nodes));
+        CHECK(backend.CreateBeams(model->beams));
+        CHECK(backend.CreateCables(model->cables));
+        CHECK(backend.Save());
+
+        StdGeometry geometry;
+        CHECK(ModelVerifier::ReadStdFile("verifier_roundtrip.std", geometry));
+        CHECK_EQ(geometry.nodeIds.size(), size_t(3));
+        CHECK_EQ(geometry.memberIds.size(), size_t(3));
+
+        VerificationOptions options;
+        VerificationReport report;
+        CHECK(ModelVerifier::Compare(*model, geometry, options, report));
+        CHECK_EQ(report.Total(), size_t(0));
+        CHECK_EQ(report.nodesChecked, size_t(3));
+        CHECK_EQ(report.membersChecked, size_t(3));
+
+        // Every kind of difference is found and attributed to its STAAD number
+        geometry.x[2] += 0.5;
+        swap(geometry.startNodes[0], geometry.endNodes[0]);
+        geometry.endNodes[1] = geometry.startNodes[1];
+        geometry.nodeIds.push_back(99);
+        geometry.x.push_back(0);
+        geometry.y.push_back(0);
+        geometry.z.push_back(0);
+        geometry.memberIds[2] = 98;
+        VerificationReport differences;
+        options.parallel = false;
+        CHECK(!ModelVerifier::Compare(*model, geometry, options, differences));
+        CHECK_EQ(Count(differences, MismatchKind::NodeMoved), size_t(1));
+        CHECK_EQ(Count(differences, MismatchKind::ExtraNode), size_t(1));
+        CHECK_EQ(Count(differences, MismatchKind::ReversedMember), size_t(1));
+        CHECK_EQ(Count(differences, MismatchKind::WrongIncidence), size_t(1));
+        CHECK_EQ(Count(differences, MismatchKind::MissingMember), size_t(1));
+        CHECK_EQ(Count(differences, MismatchKind::ExtraMember), size_t(1));
+        CHECK_EQ(Count(differences, MismatchKind::MissingNode), size_t(0));
+        for (const auto& m : differences.mismatches) {
+            if (m.kind == MismatchKind::NodeMoved) {
+                CHECK_EQ(m.staadId, model->nodes[2].staadId);
+                CHECK_NEAR(m.distance, 0.5, 1e-12);
+            }
+            if (m.kind == MismatchKind::MissingMember) CHECK_EQ(m.staadId, model->cables[0].staadId);
+        }
+    }
+}
+
+int main() {
+    TestReadStdFile();
+    TestRoundTrip();
+    return Test::Result();
+}